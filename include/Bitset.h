@@ -0,0 +1,175 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/* Packed, fixed-width set of bits used for information states and decisions.
+   Bits past size() are always kept zero so that equality, hashing and
+   counting can operate a whole word at a time */
+class Bitset {
+public:
+	typedef uint64_t Word;
+	static const int WORD_BITS = 64;
+	static const int npos = -1;
+
+	/* Proxy returned by the non-const operator[] */
+	class reference {
+	public:
+		reference(Word& word_, Word mask_) : word(word_), mask(mask_) {}
+		operator bool() const { return (word & mask) != 0; }
+		reference& operator=(bool b) {
+			if (b) word |= mask;
+			else word &= ~mask;
+			return *this;
+		}
+		reference& operator=(const reference& other) {
+			return *this = static_cast<bool>(other);
+		}
+	private:
+		Word& word;
+		Word mask;
+	};
+
+	/* Read-only iterator over every bit, in the manner of vector<bool> */
+	class const_iterator {
+	public:
+		const_iterator(const Bitset* bs_, size_t pos_) : bs(bs_), pos(pos_) {}
+		bool operator*() const { return bs->test(pos); }
+		const_iterator& operator++() { ++pos; return *this; }
+		bool operator==(const const_iterator& other) const { return pos == other.pos; }
+		bool operator!=(const const_iterator& other) const { return pos != other.pos; }
+	private:
+		const Bitset* bs;
+		size_t pos;
+	};
+
+	Bitset() : nbits(0) {}
+	explicit Bitset(size_t n, bool value = false)
+		: nbits(n), words(words_for(n), value ? ~Word(0) : Word(0)) {
+		clear_tail();
+	}
+
+	size_t size() const { return nbits; }
+	bool empty() const { return nbits == 0; }
+	void resize(size_t n, bool value = false);
+	void push_back(bool value);
+	void clear() { nbits = 0; words.clear(); }
+
+	bool test(size_t i) const {
+		return (words[i / WORD_BITS] >> (i % WORD_BITS)) & Word(1);
+	}
+	void set(size_t i) { words[i / WORD_BITS] |= Word(1) << (i % WORD_BITS); }
+	void reset(size_t i) { words[i / WORD_BITS] &= ~(Word(1) << (i % WORD_BITS)); }
+	/* Clear every bit without changing the size */
+	void reset() { for (Word& w : words) w = 0; }
+
+	bool operator[](size_t i) const { return test(i); }
+	reference operator[](size_t i) {
+		return reference(words[i / WORD_BITS], Word(1) << (i % WORD_BITS));
+	}
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, nbits); }
+
+	/* Word-at-a-time set operations--operands are expected to share a size */
+	Bitset& operator|=(const Bitset& other) {
+		for (size_t w = 0; w < words.size() && w < other.words.size(); ++w)
+			words[w] |= other.words[w];
+		return *this;
+	}
+	Bitset& operator&=(const Bitset& other) {
+		size_t w = 0;
+		for (; w < words.size() && w < other.words.size(); ++w)
+			words[w] &= other.words[w];
+		for (; w < words.size(); ++w) words[w] = 0;
+		return *this;
+	}
+	/* Remove every bit that is set in other (this &= ~other) */
+	Bitset& and_not(const Bitset& other) {
+		for (size_t w = 0; w < words.size() && w < other.words.size(); ++w)
+			words[w] &= ~other.words[w];
+		return *this;
+	}
+
+	size_t count() const {
+		size_t result = 0;
+		for (Word w : words) result += __builtin_popcountll(w);
+		return result;
+	}
+	bool any() const {
+		for (Word w : words) if (w) return true;
+		return false;
+	}
+	bool none() const { return !any(); }
+	/* Every bit set here is also set in other */
+	bool is_subset_of(const Bitset& other) const {
+		size_t w = 0;
+		for (; w < words.size() && w < other.words.size(); ++w)
+			if (words[w] & ~other.words[w]) return false;
+		/* Bits past the end of other are never in other */
+		for (; w < words.size(); ++w)
+			if (words[w]) return false;
+		return true;
+	}
+	/* At least one bit is set in both */
+	bool intersects(const Bitset& other) const {
+		for (size_t w = 0; w < words.size() && w < other.words.size(); ++w)
+			if (words[w] & other.words[w]) return true;
+		return false;
+	}
+
+	/* Number of set bits at positions less than i */
+	size_t count_before(size_t i) const {
+		size_t result = 0, w = 0;
+		for (; w < i / WORD_BITS; ++w) result += __builtin_popcountll(words[w]);
+		if (i % WORD_BITS)
+			result += __builtin_popcountll(words[w] & ((Word(1) << (i % WORD_BITS)) - 1));
+		return result;
+	}
+
+	/* Index of the first/next set bit, or npos if there is none */
+	int find_first() const { return find_from(0); }
+	int find_next(int i) const { return find_from(i + 1); }
+
+	bool operator==(const Bitset& other) const {
+		return nbits == other.nbits && words == other.words;
+	}
+	bool operator!=(const Bitset& other) const { return !(*this == other); }
+
+	size_t hash() const;
+	const Word* data() const { return words.data(); }
+	size_t num_words() const { return words.size(); }
+
+private:
+	static size_t words_for(size_t n) { return (n + WORD_BITS - 1) / WORD_BITS; }
+	void clear_tail() {
+		if (nbits % WORD_BITS)
+			words.back() &= (Word(1) << (nbits % WORD_BITS)) - 1;
+	}
+	int find_from(size_t i) const {
+		if (i >= nbits) return npos;
+		size_t w = i / WORD_BITS;
+		Word bits = words[w] & (~Word(0) << (i % WORD_BITS));
+		while (!bits) {
+			if (++w == words.size()) return npos;
+			bits = words[w];
+		}
+		return w * WORD_BITS + __builtin_ctzll(bits);
+	}
+
+	size_t nbits;
+	std::vector<Word> words;
+};
+
+/* Bitset std::hash function */
+namespace std {
+	template <>
+	struct hash<Bitset> {
+		size_t operator()(const Bitset& bs) const { return bs.hash(); }
+	};
+}
+
+#endif
@@ -1,38 +1,41 @@
 #ifndef CSR_H
 #define CSR_H
 
-#include <unordered_set>
+#include <vector>
 #include <utility>
-#include <unordered_map>
 #include "DBTS.h"
 #include "Typedef.h"
 
-/* Control simulation relation */
-class CSR_ypair{
-public:
-	YS* first;
-	Y_DBTS* second;
-	CSR_ypair(YS* y1, Y_DBTS* y2):first(y1),second(y2){}
-};
-
-class CSR_zpair{
-public:
-	ZS* first;
-	Z_DBTS* second;
-	CSR_zpair(ZS* z1, Z_DBTS* z2):first(z1),second(z2){}
-};
+/* Control simulation relation. Pairs are kept as bit-matrices: bit j of
+Y_rel[i] is set when the NBAIC Y-State with id i is related to the Y_DBTS
+with id j, and likewise for Z_rel over Z-States and Z_DBTS states */
 class CSR{
 public:
-	std::unordered_set<CSR_ypair*> Y_map;
-	std::unordered_set<CSR_zpair*> Z_map;
-	std::unordered_map<YS*, std::unordered_map<Y_DBTS*, CSR_ypair*> > Y_pair_pointers;
-	std::unordered_map<ZS*, std::unordered_map<Z_DBTS*, CSR_zpair*> > Z_pair_pointers;
 	NBAIC* aic;
 	DBTS* dbts;
 	std::ostream& os;
-	CSR(DBTS* bts_, ostream& os_);
+	CSR(DBTS* bts_, ostream& os_, int nthreads_ = 1);
+	bool contains(YS* y1, Y_DBTS* y2) const { return Y_rel[y1->id].test(y2->id); }
+	bool contains(ZS* z1, Z_DBTS* z2) const { return Z_rel[z1->id].test(z2->id); }
 	bool is_subset(const CONTROL_DECISION& CD1,const CONTROL_DECISION& CD2);
-	bool Dosearch();
 	void print();
+private:
+	std::vector<Bitset> Y_rel;
+	std::vector<Bitset> Z_rel;
+	int nthreads; /* # of threads evaluating the initial pairs */
+	/* Links into each state, by id, with the event for links into Y-States */
+	std::vector<std::vector<std::pair<ZS*, EVENT>>> YS_parents;
+	std::vector<std::vector<YS*>> ZS_parents;
+	std::vector<std::vector<std::pair<Z_DBTS*, EVENT>>> Y_DBTS_parents;
+	std::vector<std::vector<Y_DBTS*>> Z_DBTS_parents;
+	/* Pairs dropped from the relation whose parents are not yet rechecked */
+	std::vector<std::pair<YS*, Y_DBTS*>> removed_Y;
+	std::vector<std::pair<ZS*, Z_DBTS*>> removed_Z;
+	void index_parents();
+	template <typename Row_Fn>
+	void for_each_row(size_t n, Row_Fn fill_row);
+	bool Y_pair_holds(YS* y1, Y_DBTS* y2);
+	bool Z_pair_holds(ZS* z1, Z_DBTS* z2);
+	void refine();
 };
 #endif
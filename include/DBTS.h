@@ -2,16 +2,18 @@
 #define DBTS_H
 
 #include "LDS.h"
+#include "Pool.h"
 #include "Typedef.h"
 
 /* Determined Bipartite Transition System State */
 class DBTS_State {
 public:
-	DBTS_State(NBAIC_State* nbs_): nbs(nbs_){}
+	DBTS_State(NBAIC_State* nbs_): nbs(nbs_), id(-1){}
 	virtual ~DBTS_State() {}
 	bool operator==(const DBTS_State& rhs) const;
 	bool is_Y_DBTS() const { return nbs->is_YS; }
 	NBAIC_State* nbs;
+	int id; /* slot in the owning DBTS's Y-State or Z-State pool */
 	std::vector<DBTS_State*> parents;
 };
 
@@ -31,11 +33,12 @@ public:
 /* Z-State */
 class Z_DBTS : public DBTS_State {
 public:
-	Z_DBTS(ZS* zs_, CONTROL_DECISION CD_) : DBTS_State(zs_), CD(CD_) {}
+	Z_DBTS(ZS* zs_, CD_ID CD_) : DBTS_State(zs_), CD(CD_) {}
 	virtual ~Z_DBTS() {}
 	ZS* get_ZS() { return dynamic_cast<ZS*>(nbs); }
+	const CONTROL_DECISION& get_CD() const { return NBAIC_State::CDs[CD]; }
 	std::unordered_map<EVENT, Y_DBTS*> children;
-	CONTROL_DECISION CD;
+	CD_ID CD;
 };
 
 /* Determined Bipartite Transition System */
@@ -50,13 +53,19 @@ public:
 	NBAIC* aic; /* All Inclusive Controller */
 	std::vector<Y_DBTS*> YSL; /* Y_DBTS State List */
 	std::vector<Z_DBTS*> ZSL; /* Z_DBTS State List */
+	Pool<Y_DBTS> Y_pool;
+	Pool<Z_DBTS> Z_pool;
+	/* Y-States keyed by their YS, Z-States by the hash of their ZS and CD */
+	std::unordered_map<YS*, Y_DBTS*> Y_index;
+	std::unordered_multimap<size_t, Z_DBTS*> Z_index;
 	std::ostream& os;
 	REQUIRED_STATE req_states;
 	FSM* req_fsm;
-	bool DoDFS(Y_DBTS* y);
+	bool explore(Y_DBTS* y0);
+	bool expand(Y_DBTS* y, std::vector<Y_DBTS*>& worklist);
 	std::vector<STATE> get_states(YS* y);
 	CONTROL_DECISION get_cd(const std::vector<STATE> y_req_states);
-	Z_DBTS* get_Z_DBTS(ZS* z, CONTROL_DECISION Act, bool& judge);
+	Z_DBTS* get_Z_DBTS(ZS* z, CD_ID Act, bool& judge);
 	Y_DBTS* get_Y_DBTS(YS* y, bool& judge);
 
 };
@@ -7,6 +7,9 @@
 #include <string>
 #include "Typedef.h"
 #include "Bimap.h"
+#include "Mapped_File.h"
+
+class Fsm_Writer;
 
 /* Finite State Machine */
 class FSM {
@@ -16,11 +19,33 @@ public:
 	void print_txt(std::ostream& os);
 	void print_fsm(const char* const filename);
 	void print_fsm(std::ostream& os);
-	void reduce(std::ostream& os);
+	void print_fsm(Fsm_Writer& out);
+	void print_bin(const char* const filename);
 	STATE find_inaccessible(std::vector<int>& current_access);
 	bool is_invalid(Mode mode);
+	void pack_transitions();
+	/* State reached from s via e, or -1 if e is not defined at s */
+	STATE get_next(STATE s, EVENT e) const {
+		if (!enabled_events[s][e]) return -1;
+		return packed_state[packed_offset[s] + enabled_events[s].count_before(e)];
+	}
 
 	std::vector<std::unordered_map<EVENT, STATE>> transitions;
+	/* Read-only copy of transitions in contiguous memory. The transitions
+	of state s are at [packed_offset[s], packed_offset[s + 1]), sorted by
+	event. Rebuild with pack_transitions() after changing transitions */
+	std::vector<int> packed_offset;
+	std::vector<EVENT> packed_event;
+	std::vector<STATE> packed_state;
+	std::vector<Bitset> enabled_events; /* events defined at each state */
+	/* Transitions into state s are at [reverse_offset[s], reverse_offset[s + 1]) */
+	std::vector<int> reverse_offset;
+	std::vector<EVENT> reverse_event;
+	std::vector<STATE> reverse_state; /* source of each reverse transition */
+	Bitset observable_events, uncontrollable_events;
+	/* States reachable from each state via uncontrollable,
+	unobservable events, including the state itself */
+	std::vector<Bitset> uu_closure;
 	
 	Bimap<std::string, STATE> states;
 	int nstates; /* # of states */
@@ -36,14 +61,15 @@ public:
 
 private:
 	Mode mode;
+	bool umdes; /* events were declared in the UMDES .fsm format */
 	void resize();
-	void read_txt_input(std::ifstream& input);
-	void read_fsm_input(std::ifstream& input);
-	STATE find_state(std::string& A_UxG_State,
-					 Bimap<std::string, int>& state_scaler, int& scaler_count);
-	std::string get_primes(std::unordered_map<int, std::unordered_map<std::string, int>>& state_index,
-					  	   std::vector<int>& state_count, STATE parent,
-					  	   std::string& state_key);
+	void index_transitions();
+	void compute_uu_closures();
+	void read_txt_input(Token_Scanner& input);
+	void read_fsm_input(Token_Scanner& input);
+	void read_bin_input(const Mapped_File& file, const std::string& file_in);
+	void declare_txt_event(EVENT e, bool is_controllable, char o);
+	void declare_fsm_event(EVENT e, bool is_controllable, bool is_observable);
 	bool exists_accessible_marked_state();
 };
 
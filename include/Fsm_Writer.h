@@ -0,0 +1,77 @@
+#ifndef FSM_WRITER_H
+#define FSM_WRITER_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+#include "FSM.h"
+#include "NBAIC_State.h"
+#include "Typedef.h"
+
+/* Comma separated names of the FSM states or events in a subset. The
+IS_Names and CD_Names forms are formatted once per NBAIC_State or control
+decision and copied from then on */
+struct State_Names { const Bitset& IS; };
+struct Event_Names { const Bitset& CD; };
+struct IS_Names { const NBAIC_State* nbs; };
+struct CD_Names { CD_ID CD; };
+struct State_Name { STATE s; };
+struct Event_Name { EVENT e; };
+
+/* Buffered writer for the .fsm result files. Text is gathered in one large
+buffer that is handed to the file (or stream) a block at a time, and names
+are copied from tables built from the FSM's bimaps on first use instead of
+being looked up and joined into a new string for every state */
+class Fsm_Writer {
+public:
+	Fsm_Writer(const char* filename, FSM* fsm_);
+	Fsm_Writer(std::ostream& os_, FSM* fsm_);
+	~Fsm_Writer() { close(); }
+	/* Flushes the buffer; a file is closed as well */
+	void close();
+
+	Fsm_Writer& operator<<(const char* s) { return write(s, strlen(s)); }
+	Fsm_Writer& operator<<(const std::string& s) { return write(s.data(), s.size()); }
+	Fsm_Writer& operator<<(char c) {
+		if (buffer.size() == buffer.capacity()) flush();
+		buffer.push_back(c);
+		return *this;
+	}
+	Fsm_Writer& operator<<(bool b) { return *this << (b ? '1' : '0'); }
+	Fsm_Writer& operator<<(int i) { return *this << (long long) i; }
+	Fsm_Writer& operator<<(size_t i) { return *this << (long long) i; }
+	Fsm_Writer& operator<<(long long i);
+	Fsm_Writer& operator<<(State_Name name) { return *this << state_name(name.s); }
+	Fsm_Writer& operator<<(Event_Name name) { return *this << event_name(name.e); }
+	Fsm_Writer& operator<<(State_Names names);
+	Fsm_Writer& operator<<(Event_Names names);
+	Fsm_Writer& operator<<(IS_Names names);
+	Fsm_Writer& operator<<(CD_Names names);
+private:
+	Fsm_Writer(const Fsm_Writer&);
+	Fsm_Writer& operator=(const Fsm_Writer&);
+	static const size_t BUFFER_SIZE = 1 << 20;
+
+	Fsm_Writer& write(const char* s, size_t n);
+	void flush();
+	const std::string& state_name(STATE s);
+	const std::string& event_name(EVENT e);
+	void append_subset(std::string& result, const Bitset& subset, bool of_events);
+
+	FSM* fsm;
+	FILE* file;
+	std::ostream* os;
+	std::vector<char> buffer;
+	/* Names by id, pointing into the FSM's bimaps */
+	std::vector<const std::string*> state_names;
+	std::vector<const std::string*> event_names;
+	/* Formatted subsets */
+	std::unordered_map<const NBAIC_State*, std::string> IS_strings;
+	std::unordered_map<CD_ID, std::string> CD_strings;
+	std::string scratch;
+};
+
+#endif
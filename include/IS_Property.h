@@ -11,42 +11,47 @@
 class IS_Property {
 public:
 	virtual bool operator() (const INFO_STATE& IS) const = 0;
+	/* True if every superset of an IS that violates the
+	property also violates it */
+	virtual bool is_monotone() const { return false; }
 	virtual ~IS_Property() {}
 };
 
 /* Opacity--true iff IS is not a subset of secret_states */
 class Opacity : public IS_Property {
 public:
-	Opacity(const std::vector<bool>& secret_states_);
+	Opacity(const INFO_STATE& secret_states_);
 	Opacity(const std::string& filename,
 			std::unordered_map<std::string, STATE>& all_states);
 	bool operator() (const INFO_STATE& IS) const;
 private:
-	std::vector<bool> secret_states;
+	INFO_STATE secret_states;
 };
 
 /* Safety--true if no state in IS is also in unsafe_states */
 class Safety : public IS_Property {
 public:
 	Safety();
-	Safety(const std::vector<bool>& unsafe_states_);
+	Safety(const INFO_STATE& unsafe_states_);
 	Safety(const std::string& filename,
 		   std::unordered_map<std::string, STATE>& all_states);
 	bool operator() (const INFO_STATE& IS) const;
-	std::vector<bool> unsafe_states;
+	bool is_monotone() const { return true; }
+	INFO_STATE unsafe_states;
 };
 
 /* Disambiguation--true if IS does not contain
 states in both A_states & B_states aa*/
 class Disambiguation : public IS_Property {
 public:
-	Disambiguation(const std::vector<bool>& A_states_,
-			  	   const std::vector<bool>& B_states_);
+	Disambiguation(const INFO_STATE& A_states_,
+			  	   const INFO_STATE& B_states_);
 	Disambiguation(const std::string& filename,
 		   	  	   std::unordered_map<std::string, STATE>& all_states);
 	bool operator() (const INFO_STATE& IS) const;
+	bool is_monotone() const { return true; }
 private:
-	std::vector<bool> A_states, B_states;
+	INFO_STATE A_states, B_states;
 };
 
 IS_Property* get_ISP(const std::string& property, const std::string& ISP_file,
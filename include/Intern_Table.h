@@ -0,0 +1,43 @@
+#ifndef INTERN_TABLE_H
+#define INTERN_TABLE_H
+
+#include <deque>
+#include <unordered_map>
+
+/* Assigns each distinct value a small, dense id. A value is hashed once
+when it is interned; afterwards it can be stored, compared and used as a
+key by id, and resolved back to the value when it is needed. Values are
+never moved, so a reference to one stays valid as the table grows */
+template <typename T>
+class Intern_Table {
+public:
+	/* Id of val, adding val to the table if it is not there yet */
+	int intern(const T& val) {
+		auto found = ids.find(val);
+		if (found != ids.end()) return found->second;
+		int id = vals.size();
+		ids.emplace(val, id);
+		vals.push_back(val);
+		return id;
+	}
+	/* Id of val, or -1 if val has not been interned */
+	int find(const T& val) const {
+		auto found = ids.find(val);
+		return found == ids.end() ? -1 : found->second;
+	}
+	const T& operator[](int id) const { return vals[id]; }
+	int size() const { return vals.size(); }
+	void clear() {
+		vals.clear();
+		ids.clear();
+	}
+	void swap(Intern_Table& other) {
+		vals.swap(other.vals);
+		ids.swap(other.ids);
+	}
+private:
+	std::deque<T> vals;
+	std::unordered_map<T, int> ids;
+};
+
+#endif
@@ -9,14 +9,13 @@ public:
 	LDS(std::ostream& os_, NBAIC* nbaic_, ICS_STATE* entrance_state_);
 	void compute_maximal();
 	void print() const;
-	std::vector<CONTROL_DECISION> CDs;
+	std::vector<CD_ID> CDs;
 	std::vector<EVENT> events;
 private:
-	template <typename ICS_MAP>
-	void push_children(std::queue<Node<ICS_STATE*>*>& BFS,
-					   ICS_MAP& ics_map, Node<ICS_STATE*>* parent);
-	void record_path(ICS& ics, Node<ICS_STATE*>* current);
-	bool is_LDS(YS* current_YS, CONTROL_DECISION& CD, int index);
+	void push_children(Ring_Queue<int>& BFS, Search_Tree<ICS_STATE*>& tree,
+					   ICS& ics, int parent);
+	void record_path(ICS& ics, Search_Tree<ICS_STATE*>& tree, int current);
+	bool is_LDS(YS* current_YS, CD_ID CD, int index);
 	std::ostream& os;
 	NBAIC* nbaic;
 	ICS_STATE* entrance_state;
@@ -0,0 +1,122 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <functional>
+
+/* Read-only contents of a whole file. The file is memory-mapped when it
+can be and read into a buffer otherwise (pipes, empty files) */
+class Mapped_File {
+public:
+	explicit Mapped_File(const std::string& filename);
+	~Mapped_File();
+	bool is_open() const { return opened; }
+	const char* begin() const { return data; }
+	const char* end() const { return data + length; }
+	size_t size() const { return length; }
+private:
+	Mapped_File(const Mapped_File&);
+	Mapped_File& operator=(const Mapped_File&);
+
+	const char* data;
+	size_t length;
+	bool opened;
+	bool mapped;
+	std::vector<char> buffer; /* contents when the file is not mapped */
+};
+
+/* Characters [data, data + length) of a buffer that outlives the token */
+struct Token {
+	Token() : data(nullptr), length(0) {}
+	const char* data;
+	size_t length;
+	std::string str() const { return std::string(data, length); }
+	bool operator==(const Token& other) const {
+		return length == other.length && !memcmp(data, other.data, length);
+	}
+	bool operator==(const char* s) const {
+		return length == strlen(s) && !memcmp(data, s, length);
+	}
+};
+
+/* Token std::hash function (FNV-1a) */
+namespace std {
+	template <>
+	struct hash<Token> {
+		size_t operator()(const Token& token) const {
+			size_t result = 14695981039346656037ULL;
+			for (size_t i = 0; i < token.length; ++i)
+				result = (result ^ (unsigned char) token.data[i]) * 1099511628211ULL;
+			return result;
+		}
+	};
+}
+
+/* Reads whitespace separated values from a buffer the way operator>> reads
+them from an istream, down to a failed read failing every later one */
+class Token_Scanner {
+public:
+	Token_Scanner(const char* begin_, const char* end_)
+		: pos(begin_), end(end_), failed(false) {}
+	bool read(Token& token) {
+		if (!skip_space()) return false;
+		token.data = pos;
+		while (pos < end && !is_space(*pos)) ++pos;
+		token.length = pos - token.data;
+		return true;
+	}
+	/* A single character, not a whole token */
+	bool read(char& c) {
+		if (!skip_space()) return false;
+		c = *pos++;
+		return true;
+	}
+	bool read(int& i) {
+		long value;
+		if (!read_integer(value) || value != (int) value) i = 0;
+		else i = value;
+		return !failed;
+	}
+	/* 0 or 1 */
+	bool read(bool& b) {
+		long value;
+		b = read_integer(value) && value != 0;
+		if (!failed && value != 0 && value != 1) failed = true;
+		return !failed;
+	}
+	/* Next character, or EOF at the end of the buffer or after a failure */
+	int peek() const { return failed || pos == end ? EOF : *pos; }
+	void ignore() { if (!failed && pos < end) ++pos; }
+private:
+	static bool is_space(char c) {
+		return c == ' ' || (c >= '\t' && c <= '\r');
+	}
+	/* Moves to the next token--fails if there is none */
+	bool skip_space() {
+		if (failed) return false;
+		while (pos < end && is_space(*pos)) ++pos;
+		if (pos == end) failed = true;
+		return !failed;
+	}
+	bool read_integer(long& value) {
+		if (!skip_space()) return false;
+		bool negative = *pos == '-';
+		if (*pos == '-' || *pos == '+') ++pos;
+		const char* digits = pos;
+		/* Stops accumulating once out of int range, which fails below */
+		for (value = 0; pos < end && *pos >= '0' && *pos <= '9'; ++pos)
+			if (value == (int) value) value = value * 10 + (*pos - '0');
+		if (pos == digits || value != (int) value) failed = true;
+		if (negative) value = -value;
+		return !failed;
+	}
+
+	const char* pos;
+	const char* end;
+	bool failed;
+};
+
+#endif
@@ -3,7 +3,9 @@
 
 #include "ICS.h"
 #include "IS_Property.h"
-#include "BFS_Node.h"
+#include "Traversal.h"
+#include "Pool.h"
+#include "Reach_Cache.h"
 #include "Typedef.h"
 
 /* Non-Blocking All Inclusive Controller */
@@ -15,26 +17,59 @@ public:
 	friend class CSR;
 	friend class SUPV;
 	NBAIC(FSM* fsm_, IS_Property* isp_, std::ostream& os_,
-		  Mode mode_ = BSCOPNBMAX);
+		  Mode mode_ = BSCOPNBMAX, int nthreads_ = 1);
 	~NBAIC();
 	void reduce_MPO(bool generate_maximal);
 	ICS& get_ics() { return ics; }
 	FSM* get_fsm() { return fsm; }
 	bool is_empty() const { return ZSL.empty() || YSL.empty(); }
 	void print(bool print_BDO = false);
+	void print_cache_stats() const { reach_cache.print_stats(os); }
 	void print_fsm(const char* const filename);
 private:
 	FSM* fsm; /* Finite State Machine */
 	IS_Property* ISP; /* Information-State Property */
 	std::vector<YS*> YSL; /* Y-State List */
 	std::vector<ZS*> ZSL; /* Z-State List */
+	Pool<YS> YS_pool;
+	Pool<ZS> ZS_pool;
+	/* Y-States keyed by the hash of their IS */
+	std::unordered_multimap<size_t, YS*> YS_index;
+	/* Z-States keyed by the hash of their IS and CD */
+	std::unordered_multimap<size_t, ZS*> ZS_index;
 	ICS ics; /* Inter-Connected System */
+	Reach_Cache reach_cache;
 	std::ostream& os;
 	Mode mode;
+	int nthreads; /* # of threads evaluating the frontier */
 
-	void DoDFS_BSCOPNBMAX(YS* ys);
-	void DoDFS_MPO(YS* ys);
-	void DoDFS_MPRCP(YS* ys);
+	/* Decisions at one Y-State that passed the mode's checks, in power set
+	order, with the information state and transitions each one reaches */
+	struct Expansion {
+		std::vector<CONTROL_DECISION> CDs;
+		std::vector<INFO_STATE> ISs;
+		std::vector<std::vector<Transition>> UR_transitions;
+	};
+	/* Y-States evaluated per thread before their results are linked */
+	static const size_t BATCH_SIZE = 16;
+	/* Evaluates one Y-State without modifying the NBAIC */
+	typedef void (NBAIC::*Evaluate_Policy)(const YS* ys, Expansion& result);
+	void explore(YS* y0, Evaluate_Policy evaluate);
+	void evaluate_batch(Evaluate_Policy evaluate, YS* const* ys, size_t n,
+						std::vector<Expansion>& expansions);
+	void evaluate_BSCOPNBMAX(const YS* ys, Expansion& result);
+	void evaluate_MPO(const YS* ys, Expansion& result);
+	void evaluate_MPRCP(const YS* ys, Expansion& result);
+	void evaluate_lattice(const YS* ys, bool check_deadlock, Expansion& result);
+	void close_reach(INFO_STATE& reach, const Bitset& follow,
+					 std::vector<STATE>& frontier);
+	bool evaluate_decision(unsigned subset, const INFO_STATE& IS,
+						   const Bitset& follow, const std::vector<int>& max_CD,
+						   bool check_deadlock, Expansion& result,
+						   std::vector<unsigned>& order);
+	void link(YS* ys, Expansion& expansion, std::vector<YS*>& discovered);
+	void link_event(ZS* zs, INFO_STATE& IS, const EVENT e,
+					std::vector<YS*>& discovered);
 	SENSING_DECISION flag_observable(const SENSING_DECISION& SD);
 	void prune();
 	
@@ -45,52 +80,38 @@ private:
 	bool observable_reach(INFO_STATE& IS, const ZS* zs, const EVENT e,
 						  std::vector<Transition>& OR_transitions);
 	void find_next(std::queue<STATE>& BFS, const INFO_STATE& result,
-				   const STATE current, const EVENT e,
+				   const STATE current, const EVENT e, const STATE next,
 				   std::vector<Transition>& UR_transitions);
 	
 	std::vector<int> get_max_CD(const YS* ys);
-	ZS* get_ZS(const INFO_STATE& IS, const CONTROL_DECISION& CD, bool& zs_in_ZSL);
+	ZS* get_ZS(const INFO_STATE& IS, CD_ID CD, bool& zs_in_ZSL);
 	YS* get_YS(const INFO_STATE& IS, bool& ys_in_YSL);
 	bool ys_in_YSL(YS*& ys, ZS* zs, const INFO_STATE& IS, const EVENT e,
 				   std::vector<Transition>& OR_transitions);
-	CONTROL_DECISION get_CD(ZS* zs);
+	void index_state(YS* ys);
+	void index_state(ZS* zs);
+	void unindex_state(YS* ys);
+	void unindex_state(ZS* zs);
+	void destroy_state(YS* ys) { YS_pool.destroy(ys); }
+	void destroy_state(ZS* zs) { ZS_pool.destroy(zs); }
 	
 	template <typename State_List>
 	void delete_NBAIC_States(State_List& sl);
 	void delete_ICS_State(NBAIC_State* nbs);
 	void delete_inaccessible();
-	void mark_deleted(std::vector<bool>& accessible);
+	void mark_deleted(std::vector<bool>& Y_accessible,
+					  std::vector<bool>& Z_accessible);
 	void delete_states();
 
 	bool redundant(const CONTROL_DECISION& CD,
 				   const CONTROL_DECISION& used) const;
-	bool is_deadlocked(const INFO_STATE& IS, const CONTROL_DECISION& CD,
-					   const std::vector<int>& max_CD);
-	void check_BSCOPNBMAX_deadlock(const std::vector<int>& max_CD,
-								   std::queue<Node<STATE>*>& BFS,
-								   Node<STATE>* current,
-								   INFO_STATE& non_deadlocked,
-								   const CONTROL_DECISION& CD);
-	void check_MPO_deadlock(const std::vector<int>& max_SD,
-							std::queue<Node<STATE>*>& BFS,
-							Node<STATE>* current,
-							INFO_STATE& non_deadlocked,
-							const SENSING_DECISION& current_SD);
+	bool is_deadlocked(const INFO_STATE& IS, const CONTROL_DECISION& CD);
 	bool exists_livelock();
-	void check_state_deadlock(std::queue<Node<STATE>*>& BFS, Node<STATE>* current,
-							  const EVENT e, INFO_STATE& non_deadlocked,
-							  const SENSING_DECISION& current_SD);
-	template <typename ICS_MAP>
-	void check_state_livelock(std::queue<Node<ICS_STATE*>*>& BFS,
-							  Node<ICS_STATE*>* current, ICS_MAP& ics_map,
-							  std::vector<bool>& coaccessible,
-							  std::vector<bool>& visited,
-							  std::unordered_map<ICS_STATE*, int>& ics_index);
 	
-	std::unordered_map<NBAIC_State*, int> create_NBAIC_index(bool Y, bool Z) const;
 
 	void print_sets(const INFO_STATE& IS, const CONTROL_DECISION& CD);
 	std::string print_event_parameters(EVENT e);
+	void print_CD(Fsm_Writer& out, CD_ID CD);
 
 	void run_tests();
 	void deadlock_test(const INFO_STATE& IS);
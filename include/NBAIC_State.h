@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <functional>
 #include "Typedef.h"
+#include "Intern_Table.h"
 
 /* Non-Blocking All Inclusive Controller State */
 class NBAIC_State {
@@ -16,6 +17,9 @@ public:
 	std::string print() const;
 	static int nstates;
 	static int nevents;
+	/* Every control decision in use, shared by all structures */
+	static Intern_Table<CONTROL_DECISION> CDs;
+	int id; /* slot in the owning NBAIC's Y-State or Z-State pool */
 	bool deleted;
 	bool is_YS;
 	INFO_STATE IS;
@@ -32,8 +36,7 @@ public:
 	YS(const INFO_STATE& IS_);
 	virtual ~YS() {}
 	/* Link to child states */
-	std::unordered_map<CONTROL_DECISION, ZS*,
-					   std::hash<CONTROL_DECISION>> transition;
+	std::unordered_map<CD_ID, ZS*> transition;
 	/* Link to parent states */
 	std::unordered_map<EVENT, std::vector<ZS*>> reverse;
 };
@@ -42,14 +45,14 @@ public:
 class ZS : public NBAIC_State {
 public:
 	ZS();
-	ZS(const INFO_STATE& IS_, CONTROL_DECISION CD_);
+	ZS(const INFO_STATE& IS_, CD_ID CD_);
 	virtual ~ZS() {}
 	/* Link to child states */
 	std::unordered_map<EVENT, YS*> transition;
 	/* Link to parent states */
-	std::unordered_map<CONTROL_DECISION, std::vector<YS*>,
-					   std::hash<CONTROL_DECISION>> reverse;
-	CONTROL_DECISION CD;
+	std::unordered_map<CD_ID, std::vector<YS*>> reverse;
+	const CONTROL_DECISION& get_CD() const { return CDs[CD]; }
+	CD_ID CD;
 };
 
 #endif
@@ -0,0 +1,78 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <new>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+/* Arena for the states of one structure. Objects are constructed in large
+blocks rather than allocated one at a time, and everything still alive is
+released at once by clear() or the destructor. Each object's id member is
+set to its slot in the pool. Ids stay fixed for the object's lifetime and
+are always less than capacity(), so they can index parallel arrays. The
+slot of a destroyed object is reused by the next one created */
+template <typename T>
+class Pool {
+public:
+	Pool() {}
+	~Pool() { clear(); }
+
+	template <typename... Args>
+	T* create(Args&&... args) {
+		int id;
+		if (!free_ids.empty()) {
+			id = free_ids.back();
+			free_ids.pop_back();
+		}
+		else {
+			id = live.size();
+			if (id % BLOCK_SIZE == 0) blocks.push_back(new Slot[BLOCK_SIZE]);
+			live.push_back(false);
+		}
+		T* t = new (slot(id)) T(std::forward<Args>(args)...);
+		t->id = id;
+		live[id] = true;
+		return t;
+	}
+	void destroy(T* t) {
+		int id = t->id;
+		t->~T();
+		live[id] = false;
+		free_ids.push_back(id);
+	}
+	void clear() {
+		for (int id = 0; id < live.size(); ++id)
+			if (live[id]) slot(id)->~T();
+		for (Slot* block : blocks) delete[] block;
+		blocks.clear();
+		live.clear();
+		free_ids.clear();
+	}
+	int capacity() const { return live.size(); }
+	/* Exchanges contents with other--ids and pointers stay valid */
+	void swap(Pool& other) {
+		blocks.swap(other.blocks);
+		live.swap(other.live);
+		free_ids.swap(other.free_ids);
+	}
+	/* The object in slot id, which must be live */
+	T* get(int id) { return slot(id); }
+	bool is_live(int id) const { return id < live.size() && live[id]; }
+
+private:
+	typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+	static const int BLOCK_SIZE = 256;
+	T* slot(int id) {
+		return reinterpret_cast<T*>(&blocks[id / BLOCK_SIZE][id % BLOCK_SIZE]);
+	}
+	/* States are owned by exactly one structure */
+	Pool(const Pool&);
+	Pool& operator=(const Pool&);
+
+	std::vector<Slot*> blocks;
+	std::vector<bool> live;
+	std::vector<int> free_ids;
+};
+
+#endif
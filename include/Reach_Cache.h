@@ -0,0 +1,44 @@
+#ifndef REACH_CACHE_H
+#define REACH_CACHE_H
+
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include "Typedef.h"
+
+/* Memo of control decision outcomes shared by every thread building an
+NBAIC. An entry is keyed by the unobservable reach of a decision and the
+decision over all events--the same pair a Z-State is identified by--so a
+Z-State reached from several Y-States is only checked once. Entries are
+evicted oldest first once their size exceeds the capacity */
+class Reach_Cache {
+public:
+	struct Entry {
+		bool valid; /* not redundant and not deadlocked */
+		std::vector<Transition> UR_transitions;
+	};
+	static const size_t DEFAULT_CAPACITY = 64 << 20; /* bytes */
+
+	explicit Reach_Cache(size_t capacity_ = DEFAULT_CAPACITY);
+	bool find(const INFO_STATE& IS, const CONTROL_DECISION& CD, Entry& entry);
+	void insert(const INFO_STATE& IS, const CONTROL_DECISION& CD,
+				const Entry& entry);
+	void print_stats(std::ostream& os) const;
+private:
+	typedef std::pair<INFO_STATE, CONTROL_DECISION> Key;
+	struct Key_Hash {
+		size_t operator()(const Key& key) const {
+			return key.first.hash() ^ (key.second.hash() * 31);
+		}
+	};
+	static size_t size_of(const Key& key, const Entry& entry);
+
+	std::unordered_map<Key, Entry, Key_Hash> entries;
+	std::deque<Key> insertion_order;
+	size_t capacity, used; /* bytes */
+	size_t hits, misses;
+	mutable std::mutex lock;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef TRAVERSAL_H
+#define TRAVERSAL_H
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+/* Building blocks for the breadth and depth first searches over the NBAIC,
+ICS and UBTS. Each keeps its storage between searches, so a traversal that
+is repeated from many roots allocates only while its buffers are growing */
+
+/* Search tree stored as flat arrays. Node i holds an element and the index
+of the node it was reached from (none for a root) */
+template <typename T>
+class Search_Tree {
+public:
+	static const int none = -1;
+	int add(const T& val, int parent = none) {
+		vals.push_back(val);
+		parents.push_back(parent);
+		return vals.size() - 1;
+	}
+	const T& val(int i) const { return vals[i]; }
+	int parent(int i) const { return parents[i]; }
+	int size() const { return vals.size(); }
+	void clear() {
+		vals.clear();
+		parents.clear();
+	}
+private:
+	std::vector<T> vals;
+	std::vector<int> parents;
+};
+
+/* FIFO queue over a ring buffer that doubles when full */
+template <typename T>
+class Ring_Queue {
+public:
+	Ring_Queue() : head(0), count(0) {}
+	bool empty() const { return count == 0; }
+	size_t size() const { return count; }
+	const T& front() const { return buffer[head]; }
+	void push(const T& t) {
+		if (count == buffer.size()) grow();
+		buffer[(head + count) % buffer.size()] = t;
+		++count;
+	}
+	void pop() {
+		head = (head + 1) % buffer.size();
+		--count;
+	}
+	void clear() { head = count = 0; }
+private:
+	void grow() {
+		std::vector<T> larger(std::max<size_t>(16, 2 * buffer.size()));
+		for (size_t i = 0; i < count; ++i)
+			larger[i] = buffer[(head + i) % buffer.size()];
+		buffer.swap(larger);
+		head = 0;
+	}
+	std::vector<T> buffer;
+	size_t head;
+	size_t count;
+};
+
+/* Visited set over dense indices. A slot is visited when its stamp matches
+the current epoch, so clear() is constant time instead of a pass over
+every slot */
+class Visited_Set {
+public:
+	explicit Visited_Set(size_t n = 0) : stamps(n, 0), epoch(1) {}
+	size_t size() const { return stamps.size(); }
+	void resize(size_t n) { stamps.resize(n, 0); }
+	void clear() {
+		/* Stamps from an old epoch could match again after wrapping */
+		if (++epoch == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			epoch = 1;
+		}
+	}
+	bool test(size_t i) const { return stamps[i] == epoch; }
+	void set(size_t i) { stamps[i] = epoch; }
+	/* Marks i and returns true if it had not been visited */
+	bool insert(size_t i) {
+		if (test(i)) return false;
+		set(i);
+		return true;
+	}
+private:
+	std::vector<unsigned> stamps;
+	unsigned epoch;
+};
+
+#endif
@@ -3,15 +3,19 @@
 
 #include <vector>
 #include <tuple>
+#include "Bitset.h"
 
 typedef int STATE;
 typedef int EVENT;
-typedef std::vector<bool> INFO_STATE;
-typedef std::vector<bool> CONTROL_DECISION;
-typedef std::vector<bool> SENSING_DECISION;
-typedef std::vector<bool> REQUIRED_STATE;
+typedef Bitset INFO_STATE;
+typedef Bitset CONTROL_DECISION;
+typedef Bitset SENSING_DECISION;
+typedef Bitset REQUIRED_STATE;
+typedef int CD_ID; /* Control decision interned in NBAIC_State::CDs */
 typedef std::tuple<STATE, EVENT, STATE> Transition;
 
 enum Mode {INTERACTIVE, BSCOPNBMAX, MPO, CONVERT, MPRCP};
+/* Exit status of DES_Supervisor. A batch exits with the worst of its jobs */
+enum Exit_Code {EXIT_OK = 0, EXIT_INPUT_ERROR = 1, EXIT_USAGE_ERROR = 2};
 
 #endif
\ No newline at end of file
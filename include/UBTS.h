@@ -2,6 +2,7 @@
 #define UBTS_H
 
 #include "LDS.h"
+#include "Pool.h"
 #include "Typedef.h"
 
 /* Unfolded Bipartite Transition System State */
@@ -9,9 +10,9 @@ class UBTS_State {
 public:
 	UBTS_State(NBAIC_State* nbs_, int num_predecessors_);
 	virtual ~UBTS_State() {}
-	bool operator==(const UBTS_State& rhs) const;
 	bool is_Y_UBTS() const { return nbs->is_YS; }
 	NBAIC_State* nbs;
+	int id; /* slot in the owning UBTS's Y-State or Z-State pool */
 	int num_predecessors;
 	std::vector<UBTS_State*> parents;
 	UBTS_State* disambiguation_state;
@@ -35,13 +36,14 @@ public:
 /* Z-State */
 class Z_UBTS : public UBTS_State {
 public:
-	Z_UBTS(ZS* zs_, CONTROL_DECISION& CD_) : UBTS_State(zs_, 0), CD(CD_) {}
-	Z_UBTS(ZS* zs_, int num_predecessors_, CONTROL_DECISION& CD_)
+	Z_UBTS(ZS* zs_, CD_ID CD_) : UBTS_State(zs_, 0), CD(CD_) {}
+	Z_UBTS(ZS* zs_, int num_predecessors_, CD_ID CD_)
 		: UBTS_State(zs_, num_predecessors_), CD(CD_) {}
 	virtual ~Z_UBTS() {}
 	ZS* get_ZS() { return dynamic_cast<ZS*>(nbs); }
+	const CONTROL_DECISION& get_CD() const { return NBAIC_State::CDs[CD]; }
 	std::unordered_map<EVENT, Y_UBTS*> children;
-	CONTROL_DECISION CD;
+	CD_ID CD;
 };
 
 /* Unfolded Bipartite Transition System */
@@ -58,20 +60,35 @@ private:
 	NBAIC* nbaic; /* Non-Blocking All Inclusive Controller */
 	std::vector<Y_UBTS*> YSL; /* Y_UBTS State List */
 	std::vector<Z_UBTS*> ZSL; /* Z_UBTS State List */
+	Pool<Y_UBTS> Y_pool;
+	Pool<Z_UBTS> Z_pool;
 	std::ostream& os;
 	int transient_state_index;
 	Y_UBTS* terminal_Y_UBTS;
+	/* Changes not yet pushed to the ICS: states at or past these positions
+	in YSL and ZSL, and Y-States that augment gave a child */
+	size_t synced_YSL;
+	size_t synced_ZSL;
+	std::vector<Y_UBTS*> extended;
+	void mark_synced();
+	/* Expansion worklists: states before these positions in YSL and ZSL
+	have been visited */
+	size_t visited_YSL;
+	size_t visited_ZSL;
+	/* States keyed by the hash of their NBAIC_State and num_predecessors */
+	std::unordered_multimap<size_t, UBTS_State*> UBTS_index;
+	/* Reused by get_num_predecessors */
+	Ring_Queue<UBTS_State*> BFS;
+	Visited_Set visited;
 
-	bool exists_unvisited_Y_UBTS();
-	bool exists_unvisited_Z_UBTS();
 	bool Y_UBTS_is_unvisited(Y_UBTS* y_ubts);
-	bool Z_UBTS_is_unvisited(Z_UBTS* z_ubts);
 	bool Z_UBTS_is_missing_transition(Z_UBTS* z_ubts, EVENT e);
 	void visit_Y_UBTS(Y_UBTS* y_ubts);
 	void visit_Z_UBTS(Z_UBTS* z_ubts);
 	void add_child(Z_UBTS* z_ubts, EVENT e);
-	int get_num_predecessors(UBTS_State* root);
-	std::unordered_map<UBTS_State*, int> create_UBTS_index();
+	int get_num_predecessors(NBAIC_State* nbs, UBTS_State* parent);
+	UBTS_State* get_UBTS_State(NBAIC_State* nbs, int num_predecessors);
+	void add_UBTS_State(UBTS_State* ubts_state);
 	bool is_terminal_Y_UBTS(ICS_STATE* ics_state);
 	void mark_ambiguities();
 	int count_childless_Y_UBTS();
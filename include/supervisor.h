@@ -12,10 +12,12 @@ public:
 	CSR* csr;
 	std::unordered_map<YS*, Y_DBTS*> Y_req_map;
 private:
-	void DoDFS_sol(Y_DBTS* y, Y_DBTS* y_bar);
+	void explore_sol(Y_DBTS* y0, Y_DBTS* y0_bar);
+	void expand_sol(Y_DBTS* y, Y_DBTS* y_bar,
+					std::vector<std::pair<Y_DBTS*, Y_DBTS*>>& worklist);
 	bool if_contain(YS* y);
-	CONTROL_DECISION get_max_R(YS* y,Y_DBTS* y_bar);
-	CONTROL_DECISION get_max(YS* y);
+	CD_ID get_max_R(YS* y,Y_DBTS* y_bar);
+	CD_ID get_max(YS* y);
 	int get_numCD(ZS* z);
 	int get_numIS(ZS* z);
 	bool is_subset(const CONTROL_DECISION& CD1,const CONTROL_DECISION& CD2);
@@ -0,0 +1,31 @@
+#include "../include/Bitset.h"
+using namespace std;
+
+void Bitset::resize(size_t n, bool value /* = false */) {
+	size_t old_nbits = nbits;
+	words.resize(words_for(n), value ? ~Word(0) : Word(0));
+	nbits = n;
+	/* Fill the unused part of what used to be the last word */
+	if (value && n > old_nbits && old_nbits % WORD_BITS)
+		words[old_nbits / WORD_BITS] |= ~Word(0) << (old_nbits % WORD_BITS);
+	clear_tail();
+}
+
+void Bitset::push_back(bool value) {
+	if (nbits % WORD_BITS == 0) words.push_back(0);
+	if (value) set(nbits);
+	++nbits;
+}
+
+/* Mix every word into the result so that information states differing
+   in any member hash differently with high probability */
+size_t Bitset::hash() const {
+	uint64_t result = nbits * 0x9E3779B97F4A7C15ULL;
+	for (Word w : words) {
+		w *= 0xFF51AFD7ED558CCDULL;
+		w ^= w >> 33;
+		result = (result ^ w) * 0xC4CEB9FE1A85EC53ULL;
+		result ^= result >> 29;
+	}
+	return static_cast<size_t>(result);
+}
@@ -1,78 +1,124 @@
+#include <atomic>
+#include <thread>
 #include "../include/CSR.h"
 #include "../include/Utilities.h"
 using namespace std;
 
-CSR::CSR(DBTS* dbts_, ostream& os_)
-	:dbts(dbts_), os(os_), aic(dbts_->aic){
-	//Initializing Y_map;
-	for (YS* i:aic->YSL)
-		for (Y_DBTS* j:dbts->YSL){
-			CSR_ypair* temp = new CSR_ypair(i,j);
-			Y_map.insert(temp);
-			Y_pair_pointers[i][j] = temp;
-		}
-
-	for (ZS* i:aic->ZSL)
-		for (Z_DBTS* j:dbts->ZSL){
-			CSR_zpair* temp = new CSR_zpair(i,j);
-			Z_map.insert(temp);
-			Z_pair_pointers[i][j] = temp;
-		}
+/* Computes the greatest fixpoint in two steps. Every pair is first checked
+against its own states' links, assuming all successor pairs are related--
+rows are independent, so this is spread over nthreads workers. Each pair
+that fails is then removed, and only the pairs that had it as a successor
+are rechecked, until no more pairs fail */
+CSR::CSR(DBTS* dbts_, ostream& os_, int nthreads_ /*= 1*/)
+	:dbts(dbts_), os(os_), aic(dbts_->aic), nthreads(max(nthreads_, 1)){
+	index_parents();
+	Y_rel.assign(aic->YS_pool.capacity(), Bitset(dbts->Y_pool.capacity()));
+	Z_rel.assign(aic->ZS_pool.capacity(), Bitset(dbts->Z_pool.capacity()));
+	/* Z-States first, so that the Y-State rows see which Z pairs failed */
+	for_each_row(aic->ZSL.size(), [this](size_t i){
+		ZS* z1 = aic->ZSL[i];
+		for (Z_DBTS* z2:dbts->ZSL)
+			if (Z_pair_holds(z1, z2)) Z_rel[z1->id].set(z2->id);
+	});
+	for_each_row(aic->YSL.size(), [this](size_t i){
+		YS* y1 = aic->YSL[i];
+		for (Y_DBTS* y2:dbts->YSL)
+			if (Y_pair_holds(y1, y2)) Y_rel[y1->id].set(y2->id);
+	});
+	for (ZS* z1:aic->ZSL)
+		for (Z_DBTS* z2:dbts->ZSL)
+			if (!contains(z1, z2)) removed_Z.push_back(make_pair(z1, z2));
+	for (YS* y1:aic->YSL)
+		for (Y_DBTS* y2:dbts->YSL)
+			if (!contains(y1, y2)) removed_Y.push_back(make_pair(y1, y2));
+	refine();
+}
 
-	while (Dosearch()){}//search for the total CSRs.
+void CSR::index_parents(){
+	YS_parents.resize(aic->YS_pool.capacity());
+	ZS_parents.resize(aic->ZS_pool.capacity());
+	Y_DBTS_parents.resize(dbts->Y_pool.capacity());
+	Z_DBTS_parents.resize(dbts->Z_pool.capacity());
+	for (YS* y:aic->YSL)
+		for (auto& j:y->transition) ZS_parents[j.second->id].push_back(y);
+	for (ZS* z:aic->ZSL)
+		for (auto& j:z->transition)
+			YS_parents[j.second->id].push_back(make_pair(z, j.first));
+	for (Y_DBTS* y:dbts->YSL)
+		if (y->child) Z_DBTS_parents[y->child->id].push_back(y);
+	for (Z_DBTS* z:dbts->ZSL)
+		for (auto& j:z->children)
+			Y_DBTS_parents[j.second->id].push_back(make_pair(z, j.first));
 }
 
-bool CSR::Dosearch(){
-	bool need_to_delete = false;
-	auto new_Ymap = Y_map;
-	//delete pairs from Y_map to get new_Ymap.
-	for (auto i:Y_map){
+/* Calls fill_row for rows 0 to n-1. Workers claim the next row from a shared
+counter; each row is written by exactly one worker */
+template <typename Row_Fn>
+void CSR::for_each_row(size_t n, Row_Fn fill_row){
+	atomic<size_t> next(0);
+	auto worker = [&]() {
+		for (size_t i = next++; i < n; i = next++) fill_row(i);
+	};
+	size_t nworkers = min(n, (size_t) nthreads);
+	vector<thread> helpers;
+	for (size_t t = 1; t < nworkers; ++t) helpers.push_back(thread(worker));
+	worker();
+	for (thread& helper : helpers) helper.join();
+}
 
-		YS* y1 = i->first;
-		Y_DBTS* y2 = i->second;
-		CONTROL_DECISION CD_y2 = y2->child->CD;
-		Z_DBTS* z2 = y2->child;
-		bool to_delete = true;
+/* Some decision of y1 is at least y2's and leads to a Z-State related to
+y2's child */
+bool CSR::Y_pair_holds(YS* y1, Y_DBTS* y2){
+	Z_DBTS* z2 = y2->child;
+	if (!z2) return false;
+	const CONTROL_DECISION& CD_y2 = z2->get_CD();
+	for (auto& j:y1->transition)
+		if (is_subset(NBAIC_State::CDs[j.first],CD_y2) && contains(j.second, z2))
+			return true;
+	return false;
+}
 
-		for (auto j:y1->transition){
-			if (is_subset(j.first,CD_y2) && (Z_map.find(Z_pair_pointers[j.second][z2]) != Z_map.end())){
-				to_delete = false;
-				break;
-			}
-		}
-		if (to_delete){
-			need_to_delete = true;
-			new_Ymap.erase(i);
+/* Every event of z2 is defined for z1, and the Y-States it leads to are
+related. Only called before any Y pair is removed, when all are related */
+bool CSR::Z_pair_holds(ZS* z1, Z_DBTS* z2){
+	for (auto& j:z2->children)
+		if (z1->transition.find(j.first) == z1->transition.end()) return false;
+	return true;
+}
 
+void CSR::refine(){
+	while (!removed_Y.empty() || !removed_Z.empty()){
+		if (!removed_Y.empty()){
+			YS* y1 = removed_Y.back().first;
+			Y_DBTS* y2 = removed_Y.back().second;
+			removed_Y.pop_back();
+			/* Z pairs reaching (y1,y2) on a shared event now fail */
+			for (auto& z1:YS_parents[y1->id])
+				for (auto& z2:Y_DBTS_parents[y2->id])
+					if (z1.second == z2.second && contains(z1.first, z2.first)){
+						Z_rel[z1.first->id].reset(z2.first->id);
+						removed_Z.push_back(make_pair(z1.first, z2.first));
+					}
 		}
-	}
-	//delete pairs from Z_map to get new_Zmap.
-	auto new_Zmap = Z_map;
-	for (auto i:Z_map){
-		ZS* z1 = i->first;
-		Z_DBTS* z2 = i->second;
-		for (auto j:z2->children){
-			if ((z1->transition.find(j.first) == z1->transition.end()) 
-				|| (Y_map.find(Y_pair_pointers[z1->transition[j.first]][j.second]) == Y_map.end())){
-				need_to_delete = true;
-				new_Zmap.erase(i);
-				break;
-			}
+		else{
+			ZS* z1 = removed_Z.back().first;
+			Z_DBTS* z2 = removed_Z.back().second;
+			removed_Z.pop_back();
+			/* Y pairs that may have used (z1,z2) must find another decision */
+			for (Y_DBTS* y2:Z_DBTS_parents[z2->id])
+				for (YS* y1:ZS_parents[z1->id])
+					if (contains(y1, y2) && !Y_pair_holds(y1, y2)){
+						Y_rel[y1->id].reset(y2->id);
+						removed_Y.push_back(make_pair(y1, y2));
+					}
 		}
 	}
-    Z_map = new_Zmap;
-    Y_map = new_Ymap;
-    return need_to_delete;
 }
 
 
 bool CSR::is_subset(const CONTROL_DECISION& CD1,const CONTROL_DECISION& CD2){
 	//determine whether CD2 is a subset of CD1
-	for (EVENT i = 0; i < aic->fsm->nevents; i++){
-		if ((CD2[i])&&(!CD1[i]))
-			return false;
-	}
-	return true;
+	return CD2.is_subset_of(CD1);
 }
 
 void CSR::print(){
@@ -80,21 +126,24 @@ void CSR::print(){
 	       << "********************Control Simulation Relation********************\n"
 	       << "*******************************************************************\n";
 	os<<"Y state pairs:\n";
-	for (auto i:Y_map){
-		os<<"({"
-		  <<get_subset_string(i->second->get_YS()->IS, aic->fsm->states)<<"},{"
-		  <<get_subset_string(i->first->IS, aic->fsm->states)
-		  <<"})\n";
-	}
+	for (YS* y1:aic->YSL)
+		for (Y_DBTS* y2:dbts->YSL){
+			if (!contains(y1, y2)) continue;
+			os<<"({"
+			  <<get_subset_string(y2->get_YS()->IS, aic->fsm->states)<<"},{"
+			  <<get_subset_string(y1->IS, aic->fsm->states)
+			  <<"})\n";
+		}
 	os<<"Z state pairs:\n";
-	for (auto i:Z_map){
-		os<<"({{"
-		  <<get_subset_string(i->second->get_ZS()->IS, aic->fsm->states)<<"},{"
-		  <<get_subset_string(i->second->CD, aic->fsm->events)<<"}},{{"
-		  <<get_subset_string(i->first->IS, aic->fsm->states)<<"},{"
-		  <<get_subset_string(i->first->CD, aic->fsm->events)<<"}})\n";
-		
-	}
+	for (ZS* z1:aic->ZSL)
+		for (Z_DBTS* z2:dbts->ZSL){
+			if (!contains(z1, z2)) continue;
+			os<<"({{"
+			  <<get_subset_string(z2->get_ZS()->IS, aic->fsm->states)<<"},{"
+			  <<get_subset_string(z2->get_CD(), aic->fsm->events)<<"}},{{"
+			  <<get_subset_string(z1->IS, aic->fsm->states)<<"},{"
+			  <<get_subset_string(z1->get_CD(), aic->fsm->events)<<"}})\n";
+		}
 	os << "*******************************************************************\n"
 	       << "********************Control Simulation Relation********************\n"
 	       << "*******************************************************************\n";
@@ -2,12 +2,16 @@
 #include <unordered_set>
 #include "../include/DBTS.h"
 #include "../include/Utilities.h"
+#include "../include/Fsm_Writer.h"
 using namespace std;
 
+static size_t Z_DBTS_hash(ZS* z, CD_ID CD);
+
 DBTS::DBTS(NBAIC* aic_, FSM* req_fsm_, ostream& os_, bool& sol)
 	: aic(aic_), os(os_), req_fsm(req_fsm_){
 	/* Create initial Y-State */
-	Y_DBTS* y0 = new Y_DBTS(aic->YSL[0]);
+	bool judge;
+	Y_DBTS* y0 = get_Y_DBTS(aic->YSL[0], judge);
 	YSL.push_back(y0);
 	/* get required state of R in G */
 	req_states.resize(aic->fsm->nstates,false);
@@ -16,35 +20,46 @@ DBTS::DBTS(NBAIC* aic_, FSM* req_fsm_, ostream& os_, bool& sol)
 			req_states[i] = true;
 		}
 	}
-	sol = DoDFS(y0);
+	sol = explore(y0);
 
 }
 
-DBTS::~DBTS() {
-	for (Y_DBTS* y_Dbts : YSL) delete y_Dbts;
-	for (Z_DBTS* z_Dbts : ZSL) delete z_Dbts; 
-}
+/* States are released with their pools */
+DBTS::~DBTS() {}
 
 
 bool DBTS_State::operator==(const DBTS_State& rhs) const {
 	return nbs == rhs.nbs;
 }
 
-bool DBTS::DoDFS(Y_DBTS* y){
-	bool have_sol = true;
-	CONTROL_DECISION Act(aic->fsm->nevents, false);
-	
-	YS* y_state = y->get_YS();
-	std::vector<STATE> y_req_states = get_states(y_state);
-
-	if (!y_req_states.empty()){
-		Act = get_cd(y_req_states);
-		
-		if (y_state->transition.find(Act) == y_state->transition.end()){
+/* Visits the Y-States reachable from y0 with an explicit worklist rather
+than recursion--there is no solution if any of them lacks the CD that
+enables its required states */
+bool DBTS::explore(Y_DBTS* y0){
+	vector<Y_DBTS*> worklist(1, y0);
+	while (!worklist.empty()){
+		Y_DBTS* y = worklist.back();
+		worklist.pop_back();
+		if (!expand(y, worklist)){
 			os<<"No Solution"<<endl;
 			return false;
 		}
 	}
+	return true;
+}
+
+bool DBTS::expand(Y_DBTS* y, vector<Y_DBTS*>& worklist){
+	CONTROL_DECISION CD(aic->fsm->nevents, false);
+	
+	YS* y_state = y->get_YS();
+	std::vector<STATE> y_req_states = get_states(y_state);
+
+	if (!y_req_states.empty())
+		CD = get_cd(y_req_states);
+	CD_ID Act = NBAIC_State::CDs.intern(CD);
+	if (!y_req_states.empty()
+		&& y_state->transition.find(Act) == y_state->transition.end())
+		return false;
 	bool judge;
 	ZS* z_state = y_state -> transition[Act];
 	/* get the real z and judge whether the z state is already in the DBTS*/
@@ -62,19 +77,19 @@ bool DBTS::DoDFS(Y_DBTS* y){
 			new_y->parents.push_back(z);
 			if (!judge_y){
 				YSL.push_back(new_y);
-				have_sol = DoDFS(new_y);
+				worklist.push_back(new_y);
 			}
 		}
 	}
-	return have_sol;	
+	return true;
 }
 
 std::vector<STATE> DBTS::get_states(YS* y){
 	std::vector<STATE> result;
 	std::unordered_set<STATE> state_set;
 	std::queue<STATE> bfs;
-	for (STATE i = 0; i < aic->fsm->nstates; i++){
-		if (y->IS[i] && req_states[i]){
+	for (STATE i = y->IS.find_first(); i != Bitset::npos; i = y->IS.find_next(i)){
+		if (req_states[i]){
 			bfs.push(i);
 			state_set.insert(i);
 			result.push_back(i);
@@ -111,56 +126,56 @@ CONTROL_DECISION DBTS::get_cd(const std::vector<STATE> y_req_states){
 	return result;
 }
 
-Z_DBTS* DBTS::get_Z_DBTS(ZS* z, CONTROL_DECISION Act, bool& judge){
-	judge = false;
-	for (Z_DBTS* i:ZSL)
-		if (z==i->get_ZS() && Act == i->CD){
+/* The Z-State for z and Act, created and indexed if there is none yet--
+judge tells whether it already existed */
+Z_DBTS* DBTS::get_Z_DBTS(ZS* z, CD_ID Act, bool& judge){
+	size_t key = Z_DBTS_hash(z, Act);
+	/* For all Z-States whose ZS and CD share a hash with ours */
+	auto range = Z_index.equal_range(key);
+	for (auto i = range.first; i != range.second; ++i)
+		if (z == i->second->nbs && Act == i->second->CD){
 			judge = true;
-			return i;
+			return i->second;
 		}
-	return new Z_DBTS(z, Act);
+	judge = false;
+	Z_DBTS* result = Z_pool.create(z, Act);
+	Z_index.insert(make_pair(key, result));
+	return result;
 }
 
+/* The Y-State for y, created and indexed if there is none yet--judge tells
+whether it already existed */
 Y_DBTS* DBTS::get_Y_DBTS(YS* y, bool& judge){
-	judge = false;
-	for (Y_DBTS* i:YSL)
-		if (y==i->get_YS()){
-			judge = true;
-			return i;
-		}
-	return new Y_DBTS(y);;
+	Y_DBTS*& result = Y_index[y];
+	judge = result != nullptr;
+	if (!judge) result = Y_pool.create(y);
+	return result;
 }
 
 void DBTS::print(const char* const filename) {
-	ofstream file_out(filename);
+	Fsm_Writer file_out(filename, aic->fsm);
 	file_out << YSL.size() + ZSL.size()
 			 << "\r\n\r\n";
 	for (Y_DBTS* y_Dbts : YSL) {
 		if (!y_Dbts->child) continue;
-		file_out << "{" << get_subset_string(y_Dbts->get_YS()->IS,
-											  aic->fsm->states) 
+		file_out << "{" << IS_Names{y_Dbts->nbs}
 				 << "}	0	"
 				 << (y_Dbts->child ? "1" : "0") << "\r\n";
 		if (y_Dbts->child)
-			file_out << '{' << get_subset_string(y_Dbts->child->CD,
-												 aic->fsm->events) << "}	{{"
-					 << get_subset_string(y_Dbts->child->get_ZS()->IS,
-					 					  aic->fsm->states) << "},{"
-					 << get_subset_string(y_Dbts->child->CD,
-					 					  aic->fsm->events) 
+			file_out << '{' << CD_Names{y_Dbts->child->CD} << "}	{{"
+					 << IS_Names{y_Dbts->child->nbs} << "},{"
+					 << CD_Names{y_Dbts->child->CD}
 					 << "}} 	c	o\r\n";
 		file_out << "\r\n";
 	}
 	for (Z_DBTS* z_Dbts : ZSL) {
-		file_out << "{{" << get_subset_string(z_Dbts->get_ZS()->IS,
-											 aic->fsm->states) << "},{"
-				 << get_subset_string(z_Dbts->CD, aic->fsm->events) 
+		file_out << "{{" << IS_Names{z_Dbts->nbs} << "},{"
+				 << CD_Names{z_Dbts->CD}
 				 << "}}	1	"
 				 << z_Dbts->children.size() << "\r\n";
 		for (auto& pair : z_Dbts->children)
-			file_out << aic->fsm->events.get_key(pair.first) << "	{"
-					 << get_subset_string(pair.second->get_YS()->IS,
-					 					  aic->fsm->states) << "}	"
+			file_out << Event_Name{pair.first} << "	{"
+					 << IS_Names{pair.second->nbs} << "}	"
 					 << (aic->fsm->controllable[pair.first] ? "c	" : "uc	")
 					 << (aic->fsm->observable[pair.first] ? "o" : "uo")
 					 << "\r\n";
@@ -185,7 +200,7 @@ void DBTS::print() {
 				   << "\t\tZ_DBTS State {{"
 				   << get_subset_string(y_Dbts->child->get_ZS()->IS, aic->fsm->states)
 				   << "},{"
-				   << get_subset_string(y_Dbts->child->CD, aic->fsm->events)
+				   << get_subset_string(y_Dbts->child->get_CD(), aic->fsm->events)
 				   << "}}\n";
 		}
 		os << "Z-States:\n";
@@ -193,7 +208,7 @@ void DBTS::print() {
 			os << "\tZ_DBTS State: {{"
 			   << get_subset_string(z_Dbts->get_ZS()->IS, aic->fsm->states) 
 			   << "},{"
-			   << get_subset_string(z_Dbts->CD, aic->fsm->events)
+			   << get_subset_string(z_Dbts->get_CD(), aic->fsm->events)
 			   << "}}\n"
 			   << (z_Dbts->children.empty() ? "" : "\tTransitions to:\n");
 			for (auto& pair : z_Dbts->children)
@@ -207,3 +222,7 @@ void DBTS::print() {
 	   << "********************Determined Bipartite Transition System********************\n"
 	   << "******************************************************************************\n";
 }
+
+static size_t Z_DBTS_hash(ZS* z, CD_ID CD) {
+	return hash<ZS*>()(z) ^ (hash<CD_ID>()(CD) * 31);
+}
@@ -2,10 +2,15 @@
 //////////////DES Supervisor Application for BSCOPNBMAX and MPO////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <fstream>
 #include <sstream>
 #include <getopt.h>
+#include <dirent.h>
+#include <sys/stat.h>
 #include <cstring>
+#include <cstdlib>
 #include <algorithm>
+#include <unordered_set>
 #include <cctype>
 #include <string.h>
 #include "../include/UBTS.h"
@@ -14,25 +19,28 @@
 #include "../include/double_fsm.h"
 #include "../include/supervisor.h"
 #include "../include/Utilities.h"
+#include "../include/Fsm_Writer.h"
 using namespace std;
 
-#ifdef DEBUG
-ostream& out = cout;
-#else
-ostringstream oss;
-ostream& out = oss;
-#endif
+/* Console output. It is streamed to stdout, a file or nowhere as it is
+produced (see set_output), so a verbose run never holds more than a
+stream buffer of it in memory */
+ostream out(cout.rdbuf());
+ofstream out_file;
+const size_t OUT_FILE_BUFFER_SIZE = 1 << 16;
 
 Mode MODE_FLAG = BSCOPNBMAX;
 bool MPO_CONDITION_FLAG = false;
 bool VERBOSE_FLAG = false;
 bool FILE_OUT_FLAG = false;
+int NUM_THREADS = 1;
 
-const char* const INITIAL_CLEAN_UP = "rm -f ./results/*";
+const char* const RESULTS_DIR = "./results";
 string FSM_FSM_FILE = "./results/FSM.fsm";
 string REQ_FSM_FILE = "./results/REQ_FSM.fsm";
 string RESULT_FSM_FILE = "./results/RESULT_FSM.fsm";
 string FSM_TXT_FILE = "./results/FSM.txt";
+string FSM_BIN_FILE = "./results/FSM.fsmb";
 string A_UxG_FILE = "./results/A_UxG.fsm";
 string A_UxG_REDUCED_FILE = "./results/A_UxG_reduced.fsm";
 string NBAIC_FILE = "./results/NBAIC.fsm";
@@ -42,6 +50,23 @@ string EBTS_FILE = "./results/EBTS.fsm";
 string MPO_FILE = "./results/MPO.fsm";
 string BDO_FILE = "./results/BDO.fsm";
 string MPRCP_FILE = "./results/MPRCP.fsm";
+string OUTPUT_FILE = "-"; /* "-" for stdout, "null" to discard */
+string* const RESULT_FILES[] = {
+	&FSM_FSM_FILE, &REQ_FSM_FILE, &RESULT_FSM_FILE, &FSM_TXT_FILE, &FSM_BIN_FILE,
+	&A_UxG_FILE, &A_UxG_REDUCED_FILE, &NBAIC_FILE, &ICS_FILE, &UBTS_FILE,
+	&EBTS_FILE, &MPO_FILE, &BDO_FILE, &MPRCP_FILE
+};
+
+/* Settings for one run, from the command line or a line of a manifest */
+struct Job {
+	Job() : mode(BSCOPNBMAX), MPO_condition(false), verbose(false),
+			write_to_file(false), help(false), threads(1), output("-") {}
+	Mode mode;
+	bool MPO_condition, verbose, write_to_file, help;
+	int threads;
+	string FSM_file, ISP_file, property, required_property, output;
+	string manifest;
+};
 
 void do_BSCOPNBMAX(const string& FSM_file, const string& property,
 				   const string& ISP_file);
@@ -51,6 +76,13 @@ void do_MPRCP(const string& FSM_file, const string& property,
 		    const string& ISP_file, const string& required_property);
 void getstrictsub_auto(FSM* fsm,FSM* req_fsm, IS_Property* isp);
 void convert_fsm(const string& FSM_file);
+bool set_output(const string& output);
+Exit_Code parse_options(int argc, char* argv[], Job& job);
+Exit_Code run_job(const Job& job);
+Exit_Code run_manifest(const Job& defaults);
+bool can_read(const string& filename);
+void clean_results(const string& dir);
+void set_results_dir(const string& dir);
 void generate_supervisor(NBAIC* nbaic, FSM* fsm);
 void generate_activation_policy(NBAIC* nbaic, FSM* fsm);
 void generate_aic(NBAIC* nbaic, FSM* fsm);
@@ -68,8 +100,32 @@ D_FSM* cross_product(FSM* fsm_1, FSM* fsm_2);
 
 
 int main(int argc, char* argv[]) {
-	if (argc == 1) MODE_FLAG = INTERACTIVE;
-	system(INITIAL_CLEAN_UP);
+	/* Give cout its own buffer rather than a stdio call per write */
+	ios::sync_with_stdio(false);
+	out.rdbuf(cout.rdbuf());
+	Job job;
+	if (argc == 1) job.mode = INTERACTIVE;
+	Exit_Code status = parse_options(argc, argv, job);
+	if (status != EXIT_OK || job.help) {
+		if (status != EXIT_OK) cerr << "Error: printing help menu and exiting\n";
+		print_help();
+		return status;
+	}
+	clean_results(RESULTS_DIR);
+	if (!job.manifest.empty()) status = run_manifest(job);
+	else status = run_job(job);
+	out.flush();
+	/* Keep the window of an interactive session open */
+	if (job.mode == INTERACTIVE) {
+		char pause;
+		cout << "Press any key to continue...";
+		cin >> pause;
+		cout << '\n';
+	}
+	return status;
+}
+
+Exit_Code parse_options(int argc, char* argv[], Job& job) {
 	static struct option long_options[] = {
 		{"mode", required_argument, NULL, 'm'},
 		{"MPO_condition", required_argument, NULL, 'c'},
@@ -77,81 +133,193 @@ int main(int argc, char* argv[]) {
 		{"property", required_argument, NULL, 'p'},
 		{"required_property", required_argument, NULL, 'r'},
 		{"ISP_file", required_argument, NULL, 'i'},
+		{"threads", required_argument, NULL, 't'},
 		{"verbose", no_argument, NULL, 'v'},
 		{"write_to_file", no_argument, NULL, 'w'},
+		{"output", required_argument, NULL, 'o'},
+		{"batch", required_argument, NULL, 'b'},
 		{"help", no_argument, NULL, 'h'},
 		{0, 0, 0, 0}
 	};
 
-	char pause;
 	int c, index = 0;
-	string FSM_file, ISP_file, property, required_property;
-	while ((c = getopt_long(argc, argv, "m:c:f:p:r:i:vwh", long_options, &index)) != -1) {
+	/* Rescan from the start; a batch parses one argument list per job */
+	optind = 0;
+	while ((c = getopt_long(argc, argv, "m:c:f:p:r:i:t:vwo:b:h", long_options, &index)) != -1) {
 		switch (c) {
 			case 'm':
 				if (optarg) make_lower(optarg);
-				if (strcmp(optarg, "mpo") == 0) MODE_FLAG = MPO;
-				else if (strcmp(optarg, "bscopnbmax") == 0) MODE_FLAG = BSCOPNBMAX;
-				else if (strcmp(optarg, "convert") == 0) MODE_FLAG = CONVERT;
-				else if (strcmp(optarg, "interactive") == 0) MODE_FLAG = INTERACTIVE;
-				else if (strcmp(optarg, "mprcp") == 0) MODE_FLAG = MPRCP;
-				else if (VERBOSE_FLAG)
+				if (strcmp(optarg, "mpo") == 0) job.mode = MPO;
+				else if (strcmp(optarg, "bscopnbmax") == 0) job.mode = BSCOPNBMAX;
+				else if (strcmp(optarg, "convert") == 0) job.mode = CONVERT;
+				else if (strcmp(optarg, "interactive") == 0) job.mode = INTERACTIVE;
+				else if (strcmp(optarg, "mprcp") == 0) job.mode = MPRCP;
+				else if (job.verbose)
 					cerr << "Error: " << optarg << " is not a valid mode."
 						 << "Using default mode bscopnbmax.\n";
 				break;
 			case 'c':
 				make_lower(optarg);
-				if (strcmp(optarg, "max") == 0) MPO_CONDITION_FLAG = true;
-				else if (strcmp(optarg, "min") == 0) MPO_CONDITION_FLAG = false;
-				else if (VERBOSE_FLAG)
+				if (strcmp(optarg, "max") == 0) job.MPO_condition = true;
+				else if (strcmp(optarg, "min") == 0) job.MPO_condition = false;
+				else if (job.verbose)
 					cerr << "Error: " << optarg
 						 << " is not a valid MPO condition."
 						 << " Using default MPO condition min.\n";
 				break;
 			case 'f':
-				FSM_file = optarg;
+				job.FSM_file = optarg;
 				break;
 			case 'p':
 				make_lower(optarg);
-				property = optarg;
+				job.property = optarg;
 				break;
 			case 'i':
-				ISP_file = optarg;
+				job.ISP_file = optarg;
 				break;
 			case 'r':
-				required_property = optarg;
+				job.required_property = optarg;
+				break;
+			case 't':
+				job.threads = atoi(optarg);
+				if (job.threads < 1) {
+					cerr << "Error: " << optarg << " is not a valid thread count."
+						 << " Using a single thread.\n";
+					job.threads = 1;
+				}
 				break;
 			case 'v':
-				VERBOSE_FLAG = true;
+				job.verbose = true;
 				break;
 			case 'w':
-				FILE_OUT_FLAG = true;
+				job.write_to_file = true;
+				break;
+			case 'o':
+				job.output = optarg;
+				break;
+			case 'b':
+				job.manifest = optarg;
 				break;
 			case '?':
-				cerr << "Error: command " << c
-					 << " is not defined. Printing help menu and exiting\n";
+				/* getopt has already named the option */
+				return EXIT_USAGE_ERROR;
 			case 'h':
-				print_help();
-				cin.get();
-				return 0;
+				job.help = true;
+				break;
 		}
 	}
+	return EXIT_OK;
+}
+
+/* Runs a single job. Its input files are checked first, so a bad job in a
+batch is reported and skipped rather than ending the process */
+Exit_Code run_job(const Job& job) {
+	MODE_FLAG = job.mode;
+	MPO_CONDITION_FLAG = job.MPO_condition;
+	VERBOSE_FLAG = job.verbose;
+	FILE_OUT_FLAG = job.write_to_file;
+	NUM_THREADS = job.threads;
+	string FSM_file = job.FSM_file, ISP_file = job.ISP_file;
+	string property = job.property, required_property = job.required_property;
+	if (!set_output(job.output)) {
+		cerr << "Error: output file " << job.output << " could not be opened."
+			 << " Writing to stdout.\n";
+		set_output("-");
+	}
 	if (MODE_FLAG == INTERACTIVE) display_prompts(FSM_file, ISP_file, property, required_property);
+	if (!can_read(FSM_file)) return EXIT_INPUT_ERROR;
+	if (MODE_FLAG == MPRCP) {
+		if (!can_read(ISP_file) || !can_read(required_property))
+			return EXIT_INPUT_ERROR;
+	}
+	else if (MODE_FLAG != CONVERT && !property.empty() && !ISP_file.empty()
+			 && !can_read(ISP_file))
+		return EXIT_INPUT_ERROR;
+	/* Control decisions are numbered afresh for every job */
+	NBAIC_State::CDs.clear();
 	if (MODE_FLAG == BSCOPNBMAX) do_BSCOPNBMAX(FSM_file, property, ISP_file);
 	else if (MODE_FLAG == MPO) do_MPO(FSM_file, property, ISP_file);
 	else if (MODE_FLAG == CONVERT) convert_fsm(FSM_file);
 	else if (MODE_FLAG == MPRCP) do_MPRCP(FSM_file, property, ISP_file, required_property);
+	return EXIT_OK;
+}
 
-#ifndef DEBUG
-	cout << oss.str();
-#endif
+/* Runs every job in a manifest. Each line holds the options of one job, as
+they would be given on the command line, on top of the options the batch
+was started with. Blank lines and lines starting with # are skipped. With
+-w, the files of the job on line n are written to ./results/n. Returns
+the worst exit code of any job */
+Exit_Code run_manifest(const Job& defaults) {
+	ifstream manifest(defaults.manifest.c_str());
+	if (!manifest.is_open()) {
+		cerr << "Error: file \'" << defaults.manifest << "\' could not be read\n";
+		return EXIT_INPUT_ERROR;
+	}
+	Exit_Code result = EXIT_OK;
+	string line;
+	for (int line_number = 1; getline(manifest, line); ++line_number) {
+		istringstream words(line);
+		vector<string> args(1, "DES_Supervisor");
+		string word;
+		while (words >> word) args.push_back(word);
+		if (args.size() == 1 || args[1][0] == '#') continue;
+		vector<char*> argv;
+		for (string& arg : args) argv.push_back(&arg[0]);
+		argv.push_back(nullptr);
+
+		Job job(defaults);
+		job.manifest.clear();
+		Exit_Code status = parse_options(argv.size() - 1, argv.data(), job);
+		if (status == EXIT_OK && (job.help || !job.manifest.empty()
+								  || job.mode == INTERACTIVE)) {
+			cerr << "Error: help, batch and interactive modes cannot be used in a manifest\n";
+			status = EXIT_USAGE_ERROR;
+		}
+		if (status == EXIT_OK) {
+			if (job.write_to_file) {
+				string dir = string(RESULTS_DIR) + '/' + to_string(line_number);
+				mkdir(dir.c_str(), 0755);
+				clean_results(dir);
+				set_results_dir(dir);
+			}
+			status = run_job(job);
+			set_results_dir(RESULTS_DIR);
+		}
+		if (status != EXIT_OK)
+			cerr << "Error: job on line " << line_number << " of "
+				 << defaults.manifest << " failed\n";
+		result = max(result, status);
+	}
+	return result;
+}
 
-	cout << "Press any key to continue...";
-	cin >> pause;
-	cout << '\n';
-	return 0;
+/* Reports a file that cannot be opened, as the readers would have */
+bool can_read(const string& filename) {
+	ifstream file_open_test(filename.c_str());
+	if (file_open_test.is_open()) return true;
+	cerr << "Error: file \'" << filename << "\' could not be read\n";
+	return false;
 }
 
+/* Deletes the files an earlier run left in dir; subdirectories are kept */
+void clean_results(const string& dir) {
+	DIR* results = opendir(dir.c_str());
+	if (!results) return;
+	while (dirent* entry = readdir(results)) {
+		if (entry->d_name[0] == '.') continue;
+		string path = dir + '/' + entry->d_name;
+		struct stat info;
+		if (lstat(path.c_str(), &info) == 0 && !S_ISDIR(info.st_mode))
+			remove(path.c_str());
+	}
+	closedir(results);
+}
+
+/* Moves every result file into dir, keeping its name */
+void set_results_dir(const string& dir) {
+	for (string* file : RESULT_FILES)
+		*file = dir + file->substr(file->rfind('/'));
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -163,7 +331,8 @@ void do_BSCOPNBMAX(const string& FSM_file, const string& property,
 	FSM* fsm = new FSM(FSM_file);
 	IS_Property* isp = get_ISP(property, ISP_file,
 							   fsm->states.regular, VERBOSE_FLAG);
-	NBAIC* nbaic = new NBAIC(fsm, isp, out);
+	NBAIC* nbaic = new NBAIC(fsm, isp, out, BSCOPNBMAX, NUM_THREADS);
+	if (VERBOSE_FLAG) nbaic->print_cache_stats();
 	if (!nbaic->is_empty()) generate_supervisor(nbaic, fsm);
 	else if (VERBOSE_FLAG)
 		out << "No maximally permissive supervisor exists for this FSM\n";
@@ -178,7 +347,7 @@ void do_MPO(const string& FSM_file, const string& property,
 	FSM* fsm = new FSM(FSM_file, MODE_FLAG);
 	IS_Property* isp = get_ISP(property, ISP_file,
 							   fsm->states.regular, VERBOSE_FLAG);
-	NBAIC* nbaic = new NBAIC(fsm, isp, out, MODE_FLAG);
+	NBAIC* nbaic = new NBAIC(fsm, isp, out, MODE_FLAG, NUM_THREADS);
 	if (!nbaic->is_empty()) generate_activation_policy(nbaic, fsm);
 	else if (VERBOSE_FLAG)
 		out << "No " << (MPO_CONDITION_FLAG ? "maximal" : "minimal")
@@ -198,15 +367,14 @@ void do_MPRCP(const string& FSM_file, const string& property,
 
 	getsafety(fsm, safety_fsm, isp);
 	getstrictsub_auto(fsm, req_fsm, isp);
+	/* The transitions were rewritten above, so rebuild the packed table */
+	fsm->pack_transitions();
 	
-	NBAIC* nbaic = new NBAIC(fsm, isp, out, MODE_FLAG);
+	NBAIC* nbaic = new NBAIC(fsm, isp, out, MODE_FLAG, NUM_THREADS);
+	if (VERBOSE_FLAG) nbaic->print_cache_stats();
 	if (FILE_OUT_FLAG){
-		ofstream fsm_file_out(FSM_FSM_FILE.c_str());
-		fsm->print_fsm(fsm_file_out);
-		fsm_file_out.close();
-		ofstream req_file_out(REQ_FSM_FILE.c_str());
-		req_fsm->print_fsm(req_file_out);
-		req_file_out.close();
+		fsm->print_fsm(FSM_FSM_FILE.c_str());
+		req_fsm->print_fsm(REQ_FSM_FILE.c_str());
 	}
 	if (VERBOSE_FLAG){
 		out<<"FSM: \n";
@@ -222,7 +390,7 @@ void do_MPRCP(const string& FSM_file, const string& property,
 		bool sol = false;
 		DBTS* T_r = new DBTS(nbaic, req_fsm, out, sol);// get T_R
 		if (sol){
-			CSR* csr = new CSR(T_r, out);// get Control simulation relation
+			CSR* csr = new CSR(T_r, out, NUM_THREADS);// get Control simulation relation
 			
 			SUPV* sup = new SUPV(csr);// get the result supervisor
 			if (VERBOSE_FLAG){
@@ -239,9 +407,7 @@ void do_MPRCP(const string& FSM_file, const string& property,
 				ans_fsm->print_txt(out);
 			}
 			if (FILE_OUT_FLAG){
-				ofstream ans_file_out(RESULT_FSM_FILE.c_str());
-				ans_fsm->print_fsm(ans_file_out);
-				ans_file_out.close();
+				ans_fsm->print_fsm(RESULT_FSM_FILE.c_str());
 				nbaic->print_fsm(NBAIC_FILE.c_str());
 				sup->print(MPRCP_FILE.c_str());
 			}
@@ -258,9 +424,11 @@ void do_MPRCP(const string& FSM_file, const string& property,
 	delete nbaic;
 }
 
-/* Finite State Machine file conversion utility */
+/* Finite State Machine file conversion utility. The binary model is
+written alongside the converted text file */
 void convert_fsm(const string& FSM_file) {
 	FSM* fsm = new FSM(FSM_file);
+	if (FILE_OUT_FLAG) fsm->print_bin(FSM_BIN_FILE.c_str());
 	/* File extension is .fsm--convert to .txt format */
 	if (FSM_file.find(".fsm") != string::npos) {
 		if (VERBOSE_FLAG) fsm->print_txt(out);
@@ -273,11 +441,7 @@ void convert_fsm(const string& FSM_file) {
 	/* File extension is not .fsm--convert to .fsm format */
 	else {
 		if (VERBOSE_FLAG) fsm->print_fsm(out);
-		if (FILE_OUT_FLAG) {
-			ofstream file_out(FSM_FSM_FILE.c_str());
-			fsm->print_fsm(file_out);
-			file_out.close();
-		}
+		if (FILE_OUT_FLAG) fsm->print_fsm(FSM_FSM_FILE.c_str());
 	}
 }
 
@@ -303,8 +467,8 @@ void generate_supervisor(NBAIC* nbaic, FSM* fsm) {
 		/* Add transitions in the live decision string to our ubts */
 		ubts.augment(lds);
 		ubts.expand();
-		/* Rebuild ICS for new ubts */
-		ics = ICS(ubts, fsm, out);
+		/* Push the new ubts states to the ICS */
+		ics.update(ubts);
 		if (VERBOSE_FLAG) {
 			lds.print();
 			ubts.print();
@@ -314,7 +478,7 @@ void generate_supervisor(NBAIC* nbaic, FSM* fsm) {
 	}
 	
 	if (VERBOSE_FLAG) ubts.print();
-	ofstream file_out(A_UxG_FILE.c_str());
+	Fsm_Writer file_out(A_UxG_FILE.c_str(), fsm);
 	ics.print_A_UxG(ubts, file_out, FILE_OUT_FLAG, VERBOSE_FLAG);
 	file_out.close();
 	if (FILE_OUT_FLAG) {
@@ -323,7 +487,7 @@ void generate_supervisor(NBAIC* nbaic, FSM* fsm) {
 		ubts.print(UBTS_FILE.c_str(), false);
 		ubts.print(EBTS_FILE.c_str(), true);
 		ics.print_fsm(ICS_FILE.c_str());
-		ics.reduce_A_UxG(A_UxG_FILE.c_str(), A_UxG_REDUCED_FILE.c_str());
+		ics.reduce_A_UxG(ubts, A_UxG_REDUCED_FILE.c_str());
 	}
 }
 
@@ -336,6 +500,33 @@ void generate_activation_policy(NBAIC* nbaic, FSM* fsm) {
 	if (FILE_OUT_FLAG) fsm->print_fsm(FSM_FSM_FILE.c_str());
 }
 
+/* Points the console output at stdout ("-"), nowhere ("null") or a file.
+A file is truncated the first time it is used and appended to after that,
+so the jobs of a batch can share one. Returns false if the file could not
+be opened */
+bool set_output(const string& output) {
+	static char out_file_buffer[OUT_FILE_BUFFER_SIZE];
+	static unordered_set<string> opened;
+	if (output == OUTPUT_FILE) return true;
+	out.flush();
+	if (out_file.is_open()) out_file.close();
+	if (output == "-") out.rdbuf(cout.rdbuf());
+	/* Without a buffer every insertion fails before it is formatted */
+	else if (output == "null") out.rdbuf(nullptr);
+	else {
+		out_file.rdbuf()->pubsetbuf(out_file_buffer, OUT_FILE_BUFFER_SIZE);
+		out_file.open(output.c_str(), opened.count(output) ? ios::app : ios::out);
+		if (!out_file.is_open()) {
+			OUTPUT_FILE = "";
+			return false;
+		}
+		opened.insert(output);
+		out.rdbuf(out_file.rdbuf());
+	}
+	OUTPUT_FILE = output;
+	return true;
+}
+
 void generate_aic(NBAIC* nbaic, FSM* fsm){
 	if (VERBOSE_FLAG) nbaic->print();
 	if (FILE_OUT_FLAG)  nbaic->print_fsm(NBAIC_FILE.c_str());
@@ -349,8 +540,11 @@ void print_help() {
 		 << "\tFSM_file [-f] - provide an FSM file for processing\n"
 		 << "\tProperty [-p] - provide an implemented information state property\n"
 		 << "\tISP_file [-i] - provide a corresponding file for the specified ISP property\n"
+		 << "\tThreads [-t] - number of threads used to build the NBAIC and control simulation relation\n"
 		 << "\tVerbose [-v] - request more detailed output\n"
 		 << "\tWrite_to_File [-w] - write the UBTS, EBTS, NBAIC, and A_UxG to separate .fsm files in the ./results folder\n"
+		 << "\tOutput [-o] - write console output to a file instead of stdout ('-'), or discard it ('null')\n"
+		 << "\tBatch [-b] - run each line of a manifest file as a separate job\n"
 		 << "\tHelp [-h] - display help menu\n"
 		 << "For more information, please see the README document\n" << flush;
 }
@@ -644,7 +838,7 @@ void getstrictsub_auto(FSM* fsm,FSM* req_fsm, IS_Property* isp){
 	std::unordered_map<STATE, std::string> temp = fsm->states.inverse;
 	fsm->states.regular.clear();
 	fsm->states.inverse.clear();
-	std::vector<bool> unsafe_states;
+	INFO_STATE unsafe_states;
 	Safety* safe = dynamic_cast<Safety*>(isp);
 	for (STATE i=0; i<dfsm_GA->nstates;i++){
 		D_STATE* ds = dfsm_GA->states.inverse[i];
@@ -771,11 +965,12 @@ void generate_result_fsm(FSM* ans_fsm, SUPV* sup, FSM* fsm){
 
 	for (auto z_dbts:sup->ZSL){
 		ZS* zs = z_dbts->get_ZS();
+		const CONTROL_DECISION& CD = zs->get_CD();
 		for (STATE i = 0; i<fsm->nstates; i++){
 			if (zs->IS[i]){
 				STATE ans_state = ans_fsm->states.regular[fsm->states.inverse[i]];
 				for (EVENT e = 0; e<ans_fsm->nevents; e++){
-					if ((zs->CD[e])
+					if ((CD[e])
 						&&(fsm->transitions[i].find(e)!= fsm->transitions[i].end())){
 						ans_fsm->transitions[ans_state][e] = ans_fsm->states.regular[fsm->states.inverse[fsm->transitions[i][e]]];
 					}
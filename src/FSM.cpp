@@ -1,32 +1,75 @@
 #include <queue>
 #include <cstring>
 #include <cstdlib>
+#include <numeric>
+#include <cstdint>
 #include "../include/FSM.h"
+#include "../include/Fsm_Writer.h"
 using namespace std;
 
+/* Binary model format written by print_bin. The header is followed by
+these sections, each starting on an 8-byte boundary:
+	state name offsets (nstates + 1 int32) and characters
+	event name offsets (nevents + 1 int32) and characters
+	marked, controllable, observable and monitorable bitmasks (uint64 words)
+	packed_offset, packed_event and packed_state (int32)
+	each transition map's bucket count, and for each state the positions of
+	its transitions within its packed range in the map's iteration order
+Integers are stored in the byte order of the machine that wrote the file */
+struct Bin_Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t umdes;
+	int32_t nstates;
+	int32_t nevents;
+	int32_t ntransitions;
+	uint32_t state_names_size;
+	uint32_t event_names_size;
+	uint32_t reserved;
+};
+static const char BIN_MAGIC[8] = "DESFSMB";
+static const uint32_t BIN_VERSION = 1;
+
+template <typename T>
+static T get_id(const unordered_map<Token, T>& ids, Bimap<string, T>& names,
+				const Token& name);
+
 FSM::FSM(const int nstates_, const int nevents_)
-	: nstates(nstates_), nevents(nevents_) {
+	: nstates(nstates_), nevents(nevents_), umdes(false) {
 	resize();
+	pack_transitions();
 }
 
-FSM::FSM(const string& file_in, Mode mode_ /* = BSCOPNBMAX */) : mode(mode_) {
-	ifstream input(file_in.c_str());
-	if (!input.is_open()) {
+/* The file is parsed in place: names are read as tokens pointing into it
+and only copied when they are added to the state and event bimaps */
+FSM::FSM(const string& file_in, Mode mode_ /* = BSCOPNBMAX */)
+	: mode(mode_), umdes(false) {
+	Mapped_File file(file_in);
+	if (!file.is_open()) {
 		cerr << "Error: file \'" << file_in << "\' could not be read\n";
-		cin.get();
-		exit(1);
+		exit(EXIT_INPUT_ERROR);
+	}
+	/* Binary models are recognized by their contents, not their extension */
+	if (file.size() >= sizeof(Bin_Header)
+		&& !memcmp(file.begin(), BIN_MAGIC, sizeof(BIN_MAGIC))) {
+		read_bin_input(file, file_in);
+		return;
 	}
+	Token_Scanner input(file.begin(), file.end());
 	if (file_in.find(".fsm") != string::npos) {
-		input >> nstates;
+		umdes = true;
+		input.read(nstates);
 		nevents = 0;
 		resize();
 		read_fsm_input(input);
 	}
 	else {
-		input >> nstates >> nevents;
+		input.read(nstates);
+		input.read(nevents);
 		resize();
 		read_txt_input(input);
 	}
+	pack_transitions();
 }
 
 void FSM::resize() {
@@ -39,36 +82,27 @@ void FSM::resize() {
 	monitorable.resize(nevents);
 }
 
-void FSM::read_txt_input(ifstream& input) {
+void FSM::read_txt_input(Token_Scanner& input) {
+	/* Ids of the declared names, keyed by their text in the file */
+	unordered_map<Token, STATE> state_ids(nstates);
+	unordered_map<Token, EVENT> event_ids(nevents);
 	/* Create state bimap */
-	string state;
-	char m; /* marked */
+	Token state;
+	char m = 'u'; /* marked */
 	for(STATE s = 0; s < nstates; ++s) {
-		input >> state >> m;
-		states.insert(state, s);
+		input.read(state) && input.read(m);
+		states.insert(state.str(), s);
+		state_ids[state] = s;
 		if (m == 'm') marked[s] = true;
 	}
 	/* Create event bimap */
-	string event;
-	char c, o; /* controllable and observable */
+	Token event;
+	char c = 'u', o = 'u'; /* controllable and observable */
 	for (EVENT e = 0; e < nevents; ++e) {
-		input >> event >> c >> o;
-		events.insert(event, e);
-		if (c == 'c') {
-			if (mode == MPO) monitorable[e] = true;
-			else {
-				controllable[e] = true;
-				if (o == 'o') observable[e] = true;
-			}
-		}
-		else {
-			if (o == 'o') {
-				observable[e] = true;
-				uo.push_back(e);
-			}
-			else if (o == 'm') monitorable[e] = true;
-			else uu.push_back(e);
-		}
+		input.read(event) && input.read(c) && input.read(o);
+		events.insert(event.str(), e);
+		event_ids[event] = e;
+		declare_txt_event(e, c == 'c', o);
 	}
 	/* Read in transition function */
 	STATE s = -2;
@@ -76,9 +110,10 @@ void FSM::read_txt_input(ifstream& input) {
 		input.ignore();
 		++s;
 	}
-	string new_state;
-	while (input >> event && input >> new_state) {
-		transitions[s][events.get_value(event)] = states.get_value(new_state);
+	Token new_state;
+	while (input.read(event) && input.read(new_state)) {
+		transitions[s][get_id(event_ids, events, event)]
+			= get_id(state_ids, states, new_state);
 		/* May be run more than once if some state(s) has out-degree = 0 */
 		while (input.peek() == '\n') { 
 			input.ignore();
@@ -87,54 +122,249 @@ void FSM::read_txt_input(ifstream& input) {
 	}
 }
 
-void FSM::read_fsm_input(ifstream& input) {
+void FSM::read_fsm_input(Token_Scanner& input) {
 	/* Map unique strings to basic types */
 	int state_index = 0, event_index = 0;
-	string state;
+	unordered_map<Token, STATE> state_ids(nstates);
+	unordered_map<Token, EVENT> event_ids;
+	Token state;
 	bool is_marked;
 	int num_transitions;
 	/* For each state */
-	while (input >> state >> is_marked >> num_transitions) {
+	while (input.read(state) && input.read(is_marked)
+		   && input.read(num_transitions)) {
 		/* Add parent state info */
-		if (!states.find_value(state))
-			states.insert(state, state_index++);
-		STATE parent = states[state];
+		auto found = state_ids.find(state);
+		if (found == state_ids.end()) {
+			found = state_ids.insert(make_pair(state, state_index++)).first;
+			states.insert(state.str(), found->second);
+		}
+		STATE parent = found->second;
 		marked[parent] = is_marked;
 		/* For each corresponding state transition */
-		string event, child_state, c, o;
-		while (num_transitions-- && input >> event >> child_state >> c >> o) {
+		Token event, child_state, c, o;
+		while (num_transitions-- && input.read(event) && input.read(child_state)
+			   && input.read(c) && input.read(o)) {
 			/* Add child state info */
-			if (!states.find_value(child_state))
-				states.insert(child_state, state_index++);
+			found = state_ids.find(child_state);
+			if (found == state_ids.end()) {
+				found = state_ids.insert(make_pair(child_state, state_index++)).first;
+				states.insert(child_state.str(), found->second);
+			}
+			STATE child = found->second;
 			/* Add event info */
-			if (!events.find_value(event)) {
-				events.insert(event, event_index);
-				bool is_controllable = c == "c";
-				bool is_observable = o == "o";
-				if (mode == MPO) {
-					monitorable.push_back(is_controllable);
-					controllable.push_back(false);
-				}
-				else {
-					controllable.push_back(is_controllable);
-					monitorable.push_back(false);
-				}
-				observable.push_back(is_observable);
-				if (!is_controllable && !is_observable)
-					uu.push_back(event_index);
-				if (!is_controllable && is_observable)
-					uo.push_back(event_index);
-				++event_index;
+			found = event_ids.find(event);
+			if (found == event_ids.end()) {
+				found = event_ids.insert(make_pair(event, event_index)).first;
+				events.insert(event.str(), event_index);
+				controllable.push_back(false);
+				observable.push_back(false);
+				monitorable.push_back(false);
+				declare_fsm_event(event_index++, c == "c", o == "o");
 			}
 			/* Add transition */
-			STATE child = states[child_state];
-			EVENT link = events[event];
+			EVENT link = found->second;
 			transitions[parent][link] = child;
  		}
 	}
 	nevents = events.size();
 }
 
+/* Event e as declared in a .txt file--o is 'o'bservable, 'm'onitorable
+or 'u'nobservable */
+void FSM::declare_txt_event(EVENT e, bool is_controllable, char o) {
+	if (is_controllable) {
+		if (mode == MPO) monitorable[e] = true;
+		else {
+			controllable[e] = true;
+			if (o == 'o') observable[e] = true;
+		}
+	}
+	else {
+		if (o == 'o') {
+			observable[e] = true;
+			uo.push_back(e);
+		}
+		else if (o == 'm') monitorable[e] = true;
+		else uu.push_back(e);
+	}
+}
+
+/* Event e as declared in a UMDES .fsm file */
+void FSM::declare_fsm_event(EVENT e, bool is_controllable, bool is_observable) {
+	if (mode == MPO) monitorable[e] = is_controllable;
+	else controllable[e] = is_controllable;
+	observable[e] = is_observable;
+	if (!is_controllable && !is_observable) uu.push_back(e);
+	if (!is_controllable && is_observable) uo.push_back(e);
+}
+
+/* Loads a model written by print_bin. Names are copied into the bimaps;
+the arrays are copied out of the mapping in bulk. Events are declared by
+the rules of the format the model was first read from, under this FSM's
+mode */
+void FSM::read_bin_input(const Mapped_File& file, const string& file_in) {
+	const char* pos = file.begin();
+	bool truncated = false;
+	/* Next section of count items of the given size, or nullptr once the
+	file has run out */
+	auto take = [&](size_t count, size_t size) -> const char* {
+		const char* start = file.begin()
+			+ (pos - file.begin() + 7) / 8 * 8;
+		if (truncated || start > file.end()
+			|| count * size > (size_t) (file.end() - start)) {
+			truncated = true;
+			return nullptr;
+		}
+		pos = start + count * size;
+		return start;
+	};
+	const Bin_Header* header = (const Bin_Header*) take(1, sizeof(Bin_Header));
+	if (header->version != BIN_VERSION) {
+		cerr << "Error: file \'" << file_in << "\' is binary model version "
+			 << header->version << ", expected " << BIN_VERSION << '\n';
+		exit(EXIT_INPUT_ERROR);
+	}
+	umdes = header->umdes;
+	nstates = header->nstates;
+	nevents = header->nevents;
+	int ntransitions = header->ntransitions;
+	size_t state_words = (nstates + 63) / 64, event_words = (nevents + 63) / 64;
+	const int32_t* state_offsets = (const int32_t*) take(nstates + 1, 4);
+	const char* state_names = take(header->state_names_size, 1);
+	const int32_t* event_offsets = (const int32_t*) take(nevents + 1, 4);
+	const char* event_names = take(header->event_names_size, 1);
+	const uint64_t* is_marked = (const uint64_t*) take(state_words, 8);
+	const uint64_t* is_controllable = (const uint64_t*) take(event_words, 8);
+	const uint64_t* is_observable = (const uint64_t*) take(event_words, 8);
+	const uint64_t* is_monitorable = (const uint64_t*) take(event_words, 8);
+	const int32_t* offsets = (const int32_t*) take(nstates + 1, 4);
+	const int32_t* packed_events = (const int32_t*) take(ntransitions, 4);
+	const int32_t* packed_states = (const int32_t*) take(ntransitions, 4);
+	const int32_t* bucket_counts = (const int32_t*) take(nstates, 4);
+	const int32_t* map_order = (const int32_t*) take(ntransitions, 4);
+	if (truncated) {
+		cerr << "Error: file \'" << file_in << "\' is a truncated binary model\n";
+		exit(EXIT_INPUT_ERROR);
+	}
+	resize();
+	for (STATE s = 0; s < nstates; ++s) {
+		states.insert(string(state_names + state_offsets[s],
+							 state_offsets[s + 1] - state_offsets[s]), s);
+		marked[s] = (is_marked[s / 64] >> (s % 64)) & 1;
+	}
+	for (EVENT e = 0; e < nevents; ++e) {
+		events.insert(string(event_names + event_offsets[e],
+							 event_offsets[e + 1] - event_offsets[e]), e);
+		bool c = (is_controllable[e / 64] >> (e % 64)) & 1;
+		bool o = (is_observable[e / 64] >> (e % 64)) & 1;
+		bool m = (is_monitorable[e / 64] >> (e % 64)) & 1;
+		if (umdes) declare_fsm_event(e, c, o);
+		else declare_txt_event(e, c, o ? 'o' : m ? 'm' : 'u');
+	}
+	packed_offset.assign(offsets, offsets + nstates + 1);
+	packed_event.assign(packed_events, packed_events + ntransitions);
+	packed_state.assign(packed_states, packed_states + ntransitions);
+	/* Same bucket count, then the reverse of the saved iteration order--
+	this rebuilds each map with the iteration order it was saved with, so
+	anything walking the maps sees them as the text reader left them */
+	for (STATE s = 0; s < nstates; ++s) {
+		transitions[s].rehash(bucket_counts[s]);
+		for (int t = packed_offset[s + 1] - 1; t >= packed_offset[s]; --t) {
+			int slot = packed_offset[s] + map_order[t];
+			transitions[s][packed_event[slot]] = packed_state[slot];
+		}
+	}
+	index_transitions();
+}
+
+/* Copy the transition maps into sorted, contiguous arrays so that
+reach computations do not need to hash on every lookup */
+void FSM::pack_transitions() {
+	int num_transitions = 0;
+	for (auto& map : transitions) num_transitions += map.size();
+	packed_offset.assign(1, 0);
+	packed_offset.reserve(transitions.size() + 1);
+	packed_event.clear();
+	packed_event.reserve(num_transitions);
+	packed_state.clear();
+	packed_state.reserve(num_transitions);
+	Bitset enabled(nevents);
+	vector<STATE> target(nevents); /* target of each event at state s */
+	for (STATE s = 0; s < transitions.size(); ++s) {
+		enabled.reset();
+		for (auto& pair : transitions[s]) {
+			enabled.set(pair.first);
+			target[pair.first] = pair.second;
+		}
+		/* Walking the bitset yields the events in sorted order */
+		for (EVENT e = enabled.find_first(); e != Bitset::npos;
+			 e = enabled.find_next(e)) {
+			packed_event.push_back(e);
+			packed_state.push_back(target[e]);
+		}
+		packed_offset.push_back(packed_event.size());
+	}
+	index_transitions();
+}
+
+/* Rebuild the lookups derived from the packed transitions */
+void FSM::index_transitions() {
+	int num_transitions = packed_event.size();
+	enabled_events.assign(transitions.size(), Bitset(nevents));
+	for (STATE s = 0; s < transitions.size(); ++s)
+		for (int t = packed_offset[s]; t < packed_offset[s + 1]; ++t)
+			enabled_events[s].set(packed_event[t]);
+	/* Reverse transitions, grouped by target state */
+	reverse_offset.assign(transitions.size() + 1, 0);
+	for (STATE target : packed_state) ++reverse_offset[target + 1];
+	partial_sum(reverse_offset.begin(), reverse_offset.end(),
+				reverse_offset.begin());
+	reverse_event.resize(num_transitions);
+	reverse_state.resize(num_transitions);
+	vector<int> next(reverse_offset.begin(), reverse_offset.end() - 1);
+	for (STATE s = 0; s < transitions.size(); ++s)
+		for (int t = packed_offset[s]; t < packed_offset[s + 1]; ++t) {
+			int slot = next[packed_state[t]]++;
+			reverse_event[slot] = packed_event[t];
+			reverse_state[slot] = s;
+		}
+	observable_events = Bitset(nevents);
+	uncontrollable_events = Bitset(nevents);
+	for (EVENT e = 0; e < nevents; ++e) {
+		if (observable[e]) observable_events.set(e);
+		if (!controllable[e]) uncontrollable_events.set(e);
+	}
+	compute_uu_closures();
+}
+
+/* For every state, find the states reachable from it using only
+uncontrollable, unobservable events */
+void FSM::compute_uu_closures() {
+	Bitset is_uu(nevents);
+	for (EVENT e : uu) is_uu.set(e);
+	uu_closure.assign(transitions.size(), Bitset(transitions.size()));
+	vector<STATE> DFS; /* Depth First Search */
+	for (STATE s = 0; s < transitions.size(); ++s) {
+		Bitset& closure = uu_closure[s];
+		DFS.push_back(s);
+		while (!DFS.empty()) {
+			STATE current = DFS.back();
+			DFS.pop_back();
+			if (closure[current]) continue;
+			/* Closures of lower states are already complete */
+			if (current < s) {
+				closure |= uu_closure[current];
+				continue;
+			}
+			closure[current] = true;
+			for (int t = packed_offset[current]; t < packed_offset[current + 1]; ++t)
+				if (is_uu[packed_event[t]] && !closure[packed_state[t]])
+					DFS.push_back(packed_state[t]);
+		}
+	}
+}
+
 STATE FSM::find_inaccessible(vector<int>& current_access) {
 	for (STATE s = 0; s < current_access.size(); ++s)
 		if (!current_access[s]) return s;
@@ -195,98 +425,98 @@ void FSM::print_txt(ostream& os) {
 	}
 }
 
-void FSM::print_fsm(const char* const filename) {
-	ofstream file_out(filename);
-	print_fsm(file_out);
+/* Write the FSM in the binary model format (see Bin_Header). Event types
+are saved as the file declared them, so the FSM must not have been read
+in MPO mode, which folds controllability into monitorability */
+void FSM::print_bin(const char* const filename) {
+	ofstream file_out(filename, ios::binary);
+	size_t written = 0;
+	auto write = [&](const void* data, size_t size) {
+		static const char padding[8] = {};
+		file_out.write(padding, (8 - written % 8) % 8);
+		written += (8 - written % 8) % 8;
+		file_out.write((const char*) data, size);
+		written += size;
+	};
+	/* Names are packed back to back after their offsets */
+	auto write_names = [&](Bimap<string, int>& names, int n) {
+		vector<int32_t> offsets(1, 0);
+		string chars;
+		for (int i = 0; i < n; ++i) {
+			chars += names.get_key(i);
+			offsets.push_back(chars.size());
+		}
+		write(offsets.data(), offsets.size() * 4);
+		write(chars.data(), chars.size());
+	};
+	auto write_mask = [&](const vector<bool>& bits) {
+		vector<uint64_t> words((bits.size() + 63) / 64);
+		for (size_t i = 0; i < bits.size(); ++i)
+			if (bits[i]) words[i / 64] |= uint64_t(1) << (i % 64);
+		write(words.data(), words.size() * 8);
+	};
+	Bin_Header header = {};
+	memcpy(header.magic, BIN_MAGIC, sizeof(BIN_MAGIC));
+	header.version = BIN_VERSION;
+	header.umdes = umdes;
+	header.nstates = nstates;
+	header.nevents = nevents;
+	header.ntransitions = packed_event.size();
+	for (STATE s = 0; s < nstates; ++s)
+		header.state_names_size += states.get_key(s).size();
+	for (EVENT e = 0; e < nevents; ++e)
+		header.event_names_size += events.get_key(e).size();
+	write(&header, sizeof(header));
+	write_names(states, nstates);
+	write_names(events, nevents);
+	write_mask(marked);
+	write_mask(controllable);
+	write_mask(observable);
+	write_mask(monitorable);
+	write(packed_offset.data(), packed_offset.size() * 4);
+	write(packed_event.data(), packed_event.size() * 4);
+	write(packed_state.data(), packed_state.size() * 4);
+	vector<int32_t> bucket_counts, map_order;
+	for (STATE s = 0; s < nstates; ++s) {
+		bucket_counts.push_back(transitions[s].bucket_count());
+		for (auto& pair : transitions[s])
+			map_order.push_back(enabled_events[s].count_before(pair.first));
+	}
+	write(bucket_counts.data(), bucket_counts.size() * 4);
+	write(map_order.data(), map_order.size() * 4);
 	file_out.close();
 }
 
+void FSM::print_fsm(const char* const filename) {
+	Fsm_Writer out(filename, this);
+	print_fsm(out);
+}
+
 void FSM::print_fsm(ostream& os) {
-	os << nstates << "\r\n\r\n";
-	for (STATE s = 0; s < nstates; ++ s) {
-		os << states.get_key(s) << "	" << marked[s]
-		   << "	" << transitions[s].size() << "\r\n";
-		for (auto& pair : transitions[s]) {
-			os << events.get_key(pair.first) << "	"
-			   << states.get_key(pair.second) << "	"
-			   << (controllable[pair.first] ? "c" : "uc") << "	"
-			   << (observable[pair.first] ? "o" : "uo") << "\r\n";
-		}
-		os << "\r\n";
-	}
+	Fsm_Writer out(os, this);
+	print_fsm(out);
 }
 
-/* Reduce the A_UxG to a more compact and readable form */
-void FSM::reduce(ostream& os) {
-	/* Scale the FSM state to be a number between 0 and nstates */
-	Bimap<string, int> state_scaler(nstates);
-	/* Table of FSM states and the A_UxG states that contain them */
-	unordered_map<int, unordered_map<string, int>> state_index;
-	state_index.reserve(nstates);
-	/* Keep track of how many times we see a FSM state in
-	different A_UxG states */
-	vector<int> state_count(nstates);
-	int scaler_count = 0;
-	os << nstates << "\r\n\r\n";
-	for (STATE s = 0; s < nstates; ++s) {
-		string parent_key = states.get_key(s);
-		STATE parent = find_state(parent_key, state_scaler, scaler_count);
-		string parent_primes = get_primes(state_index, state_count,
-										  parent, parent_key);
-		os << state_scaler.get_key(parent) << parent_primes << "	" << marked[s]
-		   << "	" << transitions[s].size() << "\r\n";
+void FSM::print_fsm(Fsm_Writer& out) {
+	out << nstates << "\r\n\r\n";
+	for (STATE s = 0; s < nstates; ++ s) {
+		out << State_Name{s} << "	" << marked[s]
+			<< "	" << transitions[s].size() << "\r\n";
 		for (auto& pair : transitions[s]) {
-			string child_key = states.get_key(pair.second);
-			STATE child = find_state(child_key, state_scaler, scaler_count);
-			string child_primes = get_primes(state_index, state_count,
-											 child, child_key);
-			os << events.get_key(pair.first) << "	"
-			   << state_scaler.get_key(child) << child_primes << "	"
-			   << (controllable[pair.first] ? "c" : "uc") << "	"
-			   << (observable[pair.first] ? "o" : "uo") << "\r\n";
+			out << Event_Name{pair.first} << "	"
+				<< State_Name{pair.second} << "	"
+				<< (controllable[pair.first] ? "c" : "uc") << "	"
+				<< (observable[pair.first] ? "o" : "uo") << "\r\n";
 		}
-		os << "\r\n";
-	}
-}
-
-/* Extract the FSM state from the A_UxG state and map it to a unique int
-between 0 and nstates */
-STATE FSM::find_state(string& A_UxG_State, Bimap<string, int>& state_scaler,
-					  int& scaler_count) {
-	auto last_comma = A_UxG_State.find_last_of(',');
-	auto prev_comma = last_comma - 1;
-	int num_paren = 0, num_braces = 0, num_bracket = 0;
-	/* Find the next comma that is not contained
-	within some enclosing punctuation */
-	for (; prev_comma > 0; --prev_comma) {
-		char current = A_UxG_State[prev_comma];
-		if (current == ',' && num_paren == 0 &&
-			num_bracket == 0 && num_braces == 0) break;
-		else if (current == '(') --num_paren;
-		else if (current == '{') --num_braces;
-		else if (current == '[') --num_bracket;
-		else if (current == ')') ++num_paren;
-		else if (current == '}') ++num_braces;
-		else if (current == ']') ++num_bracket;
+		out << "\r\n";
 	}
-	string s = A_UxG_State.substr(prev_comma + 1, last_comma - prev_comma - 1);
-	/* Have not seen this FSM state before--create unique mapping */
-	if (!state_scaler.find_value(s))
-		state_scaler.insert(s, scaler_count++);
-	return state_scaler[s];
 }
 
-/* Return string of primes that differentiates the FSM state from any other
-A_UxG states with the same FSM state */
-string FSM::get_primes(unordered_map<int, unordered_map<string, int>>& state_index,
-				  	   vector<int>& state_count, STATE s, string& state_key) {
-	int result = 0;
-	/* Have not seen this A_UxG state before--update # of primes */
-	if (state_index[s].find(state_key) == state_index[s].end()) {
-		result = state_count[s]++;
-		state_index[s][state_key] = result;
-	}
-	/* A_UxG state has been seen before--use precomputed value */
-	else result = state_index[s][state_key];
-	return string(result, '\'');
-}
+/* Id of a name read from the file. A name that was never declared gets the
+same default id (and bimap entry) the stream-based reader gave it */
+template <typename T>
+static T get_id(const unordered_map<Token, T>& ids, Bimap<string, T>& names,
+				const Token& name) {
+	auto found = ids.find(name);
+	return found != ids.end() ? found->second : names.get_value(name.str());
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "../include/Fsm_Writer.h"
+using namespace std;
+
+Fsm_Writer::Fsm_Writer(const char* filename, FSM* fsm_)
+	: fsm(fsm_), file(fopen(filename, "wb")), os(nullptr) {
+	buffer.reserve(BUFFER_SIZE);
+}
+
+Fsm_Writer::Fsm_Writer(ostream& os_, FSM* fsm_)
+	: fsm(fsm_), file(nullptr), os(&os_) {
+	buffer.reserve(BUFFER_SIZE);
+}
+
+void Fsm_Writer::close() {
+	flush();
+	if (file) fclose(file);
+	file = nullptr;
+}
+
+void Fsm_Writer::flush() {
+	if (file) fwrite(buffer.data(), 1, buffer.size(), file);
+	else if (os) os->write(buffer.data(), buffer.size());
+	buffer.clear();
+}
+
+Fsm_Writer& Fsm_Writer::write(const char* s, size_t n) {
+	if (buffer.size() + n > buffer.capacity()) {
+		flush();
+		/* Too large to be worth buffering */
+		if (n > buffer.capacity()) {
+			if (file) fwrite(s, 1, n, file);
+			else if (os) os->write(s, n);
+			return *this;
+		}
+	}
+	buffer.insert(buffer.end(), s, s + n);
+	return *this;
+}
+
+Fsm_Writer& Fsm_Writer::operator<<(long long i) {
+	char digits[24];
+	int n = sizeof(digits);
+	unsigned long long u = i < 0 ? -(unsigned long long) i : i;
+	do digits[--n] = '0' + u % 10; while (u /= 10);
+	if (i < 0) digits[--n] = '-';
+	return write(digits + n, sizeof(digits) - n);
+}
+
+Fsm_Writer& Fsm_Writer::operator<<(State_Names names) {
+	scratch.clear();
+	append_subset(scratch, names.IS, false);
+	return *this << scratch;
+}
+
+Fsm_Writer& Fsm_Writer::operator<<(Event_Names names) {
+	scratch.clear();
+	append_subset(scratch, names.CD, true);
+	return *this << scratch;
+}
+
+Fsm_Writer& Fsm_Writer::operator<<(IS_Names names) {
+	auto found = IS_strings.find(names.nbs);
+	if (found == IS_strings.end()) {
+		found = IS_strings.insert(make_pair(names.nbs, string())).first;
+		append_subset(found->second, names.nbs->IS, false);
+	}
+	return *this << found->second;
+}
+
+Fsm_Writer& Fsm_Writer::operator<<(CD_Names names) {
+	auto found = CD_strings.find(names.CD);
+	if (found == CD_strings.end()) {
+		found = CD_strings.insert(make_pair(names.CD, string())).first;
+		append_subset(found->second, NBAIC_State::CDs[names.CD], true);
+	}
+	return *this << found->second;
+}
+
+/* Same text as get_subset_string */
+void Fsm_Writer::append_subset(string& result, const Bitset& subset,
+							   bool of_events) {
+	int first = subset.find_first();
+	for (int i = first; i != Bitset::npos; i = subset.find_next(i)) {
+		if (i != first) result += ',';
+		result += of_events ? event_name(i) : state_name(i);
+	}
+}
+
+const string& Fsm_Writer::state_name(STATE s) {
+	if (s >= (STATE) state_names.size()) state_names.resize(s + 1, nullptr);
+	if (!state_names[s]) state_names[s] = &fsm->states.get_key(s);
+	return *state_names[s];
+}
+
+const string& Fsm_Writer::event_name(EVENT e) {
+	if (e >= (EVENT) event_names.size()) event_names.resize(e + 1, nullptr);
+	if (!event_names[e]) event_names[e] = &fsm->events.get_key(e);
+	return *event_names[e];
+}
@@ -1,91 +1,97 @@
 #include <algorithm>
+#include <numeric>
 #include "../include/ICS.h"
 #include "../include/UBTS.h"
 #include "../include/Utilities.h"
+#include "../include/Fsm_Writer.h"
 using namespace std;
 
-template <typename BOOL_CONTAINER>
-static void record_path(BOOL_CONTAINER& bc, Node<ICS_STATE*>* current,
-				 		unordered_map<ICS_STATE*, int>& ics_index);
-template <typename ICS_MAP>
-void find_next_state(stack<Node<ICS_STATE*>*>& DFS, Node<ICS_STATE*>* current,
-					 ICS_MAP& ics_map);
-void push_child_to_stack(stack<Node<ICS_STATE*>*>& DFS,
-						 Node<ICS_STATE*>* parent,
-						 Node<ICS_STATE*>* child);
-void backtrack(Node<ICS_STATE*>* current);
-Node<ICS_STATE*>* make_child(Node<ICS_STATE*>* current, ICS_STATE* child);
+void find_next_state(vector<int>& DFS, Search_Tree<int>& tree, int current,
+					 const vector<ICS_Link>& links);
 
 
 ///////////////////////////////////////////////////////////////////////////////
 
 
-ICS::ICS(UBTS& ubts, FSM* fsm_, ostream& os_) : fsm(fsm_), os(os_) {
+ICS::ICS(UBTS& ubts, FSM* fsm_, ostream& os_)
+	: fsm(fsm_), os(os_), terminal_state(nullptr), root_ics(nullptr) {
 	ubts.mark_ambiguities();
 	/* Add transitions from Y_UBTS states to Z_UBTS states*/
-	for (Y_UBTS* y_ubts : ubts.YSL)
-		if (y_ubts->child)
-			push(y_ubts->get_YS(), y_ubts->child->get_ZS(),
-				 y_ubts->child->CD, y_ubts->num_predecessors,
-				 y_ubts->child->num_predecessors,
-				 y_ubts->disambiguation_state);
-		else {
-			YS* ys = y_ubts->get_YS();
-			for (STATE s = 0; s < ys->IS.size(); ++s) {
-				if (!ys->IS[s]) continue;
-				ICS_STATE* y_ics = get_ICS_STATE(y_ubts->nbs, s,
-												 y_ubts->num_predecessors);
-				ICS_STATE* y_ics_0 = get_ICS_STATE(y_ubts->nbs, s);
-				Y_Z[y_ics] = Y_Z[y_ics_0];
-				y_ics->set_disambiguation_state(y_ics_0->get_disambiguation_state());
-				terminal_state = y_ics;
-			}
-		}
-	/* Add transitions from Z_UBTS states to Z_UBTS states*/
-	for (Z_UBTS* z_ubts : ubts.ZSL) {
-		push_internal_transitions(z_ubts->get_ZS(), z_ubts->CD,
-								  z_ubts->num_predecessors);
-		/* Add transitions from Z_UBTS states to Y_UBTS states*/
-		for (auto& pair : z_ubts->children)
-			if (z_ubts->CD[pair.first] || !fsm->controllable.at(pair.first))
-				push_external_transitions(z_ubts->get_ZS(),
-										  pair.second->get_YS(), pair.first,
-										  z_ubts->num_predecessors,
-										  pair.second->num_predecessors,
-										  pair.second->disambiguation_state);
-	}
+	for (Y_UBTS* y_ubts : ubts.YSL) push_Y_UBTS(y_ubts);
+	/* Add transitions from Z_UBTS states */
+	for (Z_UBTS* z_ubts : ubts.ZSL) push_Z_UBTS(z_ubts);
 	root_ics = get_ptr[ICS_STATE(ubts.nbaic->YSL[0], 0)];
+	ubts.mark_synced();
 }
 
 /* Copy Constructor */
 ICS::ICS(const ICS& other)
-	: fsm(other.fsm), os(other.os), terminal_state(other.terminal_state) {
+	: fsm(other.fsm), os(other.os), terminal_state(other.terminal_state),
+	  root_ics(nullptr) {
 	copy_memory(other);
 }
 
+/* Move Constructor */
+ICS::ICS(ICS&& other)
+	: fsm(other.fsm), os(other.os), terminal_state(nullptr), root_ics(nullptr) {
+	move_memory(other);
+}
+
 /* Assignment Operator */
 ICS& ICS::operator=(const ICS& other) {
 	if (this == &other) return *this;
 	delete_memory();
 	copy_memory(other);
+	return *this;
 }
 
-ICS::~ICS() {
-	for (auto& pair : get_ptr)
-		delete pair.second;
+/* Move Assignment Operator */
+ICS& ICS::operator=(ICS&& other) {
+	if (this == &other) return *this;
+	delete_memory();
+	move_memory(other);
+	return *this;
 }
 
+/* States are released with their pool */
+ICS::~ICS() {}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 
 
-void ICS::push(YS* ys, ZS* zs, const CONTROL_DECISION& CD,
+/* Brings an ICS built from ubts up to date after UBTS::augment and
+UBTS::expand, giving the same ICS as rebuilding from ubts. Only the
+states those calls added are pushed, along with the Y-States augment
+gave a child; the rest of the ICS is left in place */
+void ICS::update(UBTS& ubts) {
+	ubts.mark_ambiguities();
+	/* A childless Y-State borrowed the transitions of its first
+	occurrence--replace them with its own */
+	for (Y_UBTS* y_ubts : ubts.extended) {
+		YS* ys = y_ubts->get_YS();
+		for (STATE s = ys->IS.find_first(); s != Bitset::npos;
+			 s = ys->IS.find_next(s)) {
+			ICS_STATE* y_ics = get_ICS_STATE(y_ubts->nbs, s,
+											 y_ubts->num_predecessors);
+			unlink_children(y_ics);
+			y_ics->set_disambiguation_state(y_ubts->disambiguation_state);
+		}
+		push_Y_UBTS(y_ubts);
+	}
+	for (size_t i = ubts.synced_YSL; i < ubts.YSL.size(); ++i)
+		push_Y_UBTS(ubts.YSL[i]);
+	for (size_t i = ubts.synced_ZSL; i < ubts.ZSL.size(); ++i)
+		push_Z_UBTS(ubts.ZSL[i]);
+	ubts.mark_synced();
+}
+
+void ICS::push(YS* ys, ZS* zs, CD_ID CD,
 			   int p_index /*= 0*/, int c_index /*= 0*/,
 			   UBTS_State* disambiguation_state /* = nullptr */) {
 	/* Split YS into seperate states for each member of IS */
-	for (STATE s = 0; s < ys->IS.size(); ++s)
-		if (ys->IS[s]) push_helper(ys, s, zs, s, Y_Z, CD, p_index,
-								   c_index, disambiguation_state);
+	for (STATE s = ys->IS.find_first(); s != Bitset::npos; s = ys->IS.find_next(s))
+		push_helper(ys, s, zs, s, CD, p_index, c_index, disambiguation_state);
 }
 
 void ICS::push(ZS* zs, NBAIC_State* nbs,
@@ -94,8 +100,7 @@ void ICS::push(ZS* zs, NBAIC_State* nbs,
 	/* Split ZS into seperate states for each member of IS */
 	for (auto& transition : transitions)
 		push_helper(zs, get<0>(transition),
-					nbs, get<2>(transition),
-					Z_YZ, get<1>(transition), 0, 0,
+					nbs, get<2>(transition), get<1>(transition), 0, 0,
 					disambiguation_state);
 }
 
@@ -103,118 +108,79 @@ void ICS::pop(NBAIC_State* nbs, STATE s) {
 	/* Find the pointer to the ICS_STATE matching input args */
 	ICS_STATE ics_state(nbs, s);
 	ICS_STATE* ics_ptr = get_ptr[ics_state];
-	if (ics_ptr->is_Y_ICS()) {
-		if (ics_ptr == root_ics) root_ics = nullptr;
-		/* Delete any links to child states */
-		for (auto& child : Y_Z[ics_ptr])
-			delete_child_link(child.second, ics_ptr);
-		/* Delete any links to parent states */
-		for (ICS_STATE* parent : reverse[ics_ptr])
-			delete_parent_link(find_link(Z_YZ[parent], ics_ptr),
-							   Z_YZ, parent);
-		/* Delete this state */
-		Y_Z.erase(ics_ptr);
+	int id = ics_ptr->id;
+	if (ics_ptr == root_ics) root_ics = nullptr;
+	/* Delete any links to parent states */
+	for (int parent : parents[id]) {
+		/* Parents may have lost their only path to a marked state */
+		stale.push_back(parent);
+		vector<ICS_Link>& links = children[parent];
+		links.erase(remove_if(links.begin(), links.end(),
+							  [id](const ICS_Link& link) { return link.child == id; }),
+					links.end());
 	}
-	else {
-		/* Delete any links to child states */
-		for (auto& child : Z_YZ[ics_ptr])
-			delete_child_link(child.second, ics_ptr);
-		/* Delete any links to parent states */
-		for (ICS_STATE* parent : reverse[ics_ptr]) {
-			if (parent->is_Y_ICS())
-				delete_parent_link(find_link(Y_Z[parent], ics_ptr),
-								   Y_Z, parent);
-			else
-				delete_parent_link(find_link(Z_YZ[parent], ics_ptr),
-								   Z_YZ, parent);
-		}
-		/* Delete this state */
-		Z_YZ.erase(ics_ptr);
-	}
-	reverse.erase(ics_ptr);
+	/* Delete any links to child states */
+	for (ICS_Link& link : children[id]) unlink_parent(id, link.child);
+	/* Delete this state--its slot is reused by the next state created */
+	children[id].clear();
+	parents[id].clear();
 	get_ptr.erase(ics_state);
-	delete ics_ptr;
+	states.destroy(ics_ptr);
 }
 
 /* Returns true if there exists a Y-ICS State that is not coaccessible
-(i.e., cannot reach a marked ICS state) */
+(i.e., cannot reach a marked ICS state). Every such state's NBAIC_State
+is marked deleted, so one call removes all of the current livelocks */
 bool ICS::exists_livelock(bool& root_is_coaccessible) {
-	unordered_map<ICS_STATE*, int> ics_index = create_ics_index();
-
-	if (ics_index.empty()) {
+	if (!get_root()) {
 		root_is_coaccessible = false;
 		return false;
 	}
-	vector<bool> coaccessible(ics_index.size(), false);
-
-	for (auto iter = Y_Z.begin(); iter != Y_Z.end(); ) {
-		ICS_STATE* ics_state = (*iter++).first;
-
-		/* Previously found to be coaccessible in the path of another state */
-		if (coaccessible[ics_index[ics_state]]) continue;
-
-		vector<bool> visited(ics_index.size(), false);
-		queue<Node<ICS_STATE*>*> BFS;
-		Node<ICS_STATE*>* root = new Node<ICS_STATE*>(ics_state);
-		BFS.push(root);
-		livelock_BFS(BFS, root, coaccessible, visited, ics_index);
-
-		/* BFS found no path to a marked state--must be livelocked */
-		if (!coaccessible[ics_index[root->val]]) {
-			root->val->get_nbs()->deleted = true;
-			reset_tree(root);
-			return true;
+	update_coaccessible();
+	bool livelock = false;
+	for (int id = 0; id < states.capacity(); ++id) {
+		if (!states.is_live(id)) continue;
+		ICS_STATE* ics_state = states.get(id);
+		/* No path to a marked state--must be livelocked */
+		if (ics_state->is_Y_ICS() && !coaccessible[id]) {
+			ics_state->get_nbs()->deleted = true;
+			livelock = true;
 		}
-		reset_tree(root);
 	}
-	return false;
+	return livelock;
 }
 
 ICS_STATE* ICS::get_entrance_state(UBTS& ubts) {
-	unordered_map<ICS_STATE*, int> ics_index = create_ics_index();
-	vector<bool> coaccessible(ics_index.size());
-
-	for (auto iter = Y_Z.begin(); iter != Y_Z.end(); ) {
-		ICS_STATE* ics_state = (*iter++).first;
-
-		/* Previously found to be coaccessible in the path of another state */
-		if (coaccessible[ics_index[ics_state]]) continue;
-
-		vector<bool> visited(ics_index.size());
-		queue<Node<ICS_STATE*>*> BFS;
-		Node<ICS_STATE*>* root = new Node<ICS_STATE*>(ics_state);
-		BFS.push(root);
-		livelock_BFS(BFS, root, coaccessible, visited, ics_index);
-		reset_tree(root);
-	}
-	/* All states coaccessible--no CELC exists */
-	if (find(coaccessible.begin(), coaccessible.end(), false)
-		  == coaccessible.end()) return nullptr;
-	return find_CELC(ics_index, coaccessible, ubts);
+	update_coaccessible();
+	/* Only states reachable from the root can be part of a CELC */
+	vector<bool> reachable = find_reachable();
+	return find_CELC(reachable, ubts);
 }
 
 /* Return event that links parent to child in ICS */
 EVENT ICS::get_event(ICS_STATE* child, ICS_STATE* parent) {
-	for (auto& pair : Z_YZ[parent])
-		if (pair.second == child) return pair.first;
+	for (ICS_Link& link : children[parent->id])
+		if (link.child == child->id) return link.control;
+	return -1;
 }
 
 /* Return CD that links parent to child in ICS */
-CONTROL_DECISION ICS::get_CD(ICS_STATE* child, ICS_STATE* parent) {
-	for (auto& pair : Y_Z[parent])
-		if (pair.second == child) return pair.first;
+CD_ID ICS::get_CD(ICS_STATE* child, ICS_STATE* parent) {
+	for (ICS_Link& link : children[parent->id])
+		if (link.child == child->id) return link.control;
+	return -1;
 }
 
 ICS_STATE* ICS::get_root() {
 	if (root_ics) {return root_ics;}
-	for (auto& pair : Y_Z) {
-		ICS_STATE* ics_state = pair.first;
-		if (ics_state->get_state() == 0 &&
+	for (int id = 0; id < states.capacity(); ++id) {
+		if (!states.is_live(id)) continue;
+		ICS_STATE* ics_state = states.get(id);
+		if (ics_state->is_Y_ICS() &&
+			ics_state->get_state() == 0 &&
 			ics_state->get_transient_index() == 0 &&
 			ics_state->get_nbs()->IS[0] &&
-			find(ics_state->get_nbs()->IS.begin() + 1,
-				 ics_state->get_nbs()->IS.end(), true) ==
-				 ics_state->get_nbs()->IS.end()) {
+			ics_state->get_nbs()->IS.count() == 1) {
 			root_ics = ics_state;
 			return ics_state;
 		}
@@ -227,34 +193,42 @@ void ICS::print() {
 	   << "*********************Inter-Connected System************************\n"
 	   << "*******************************************************************\n";
 	os << "Y-ICS States:\n";
-	for (auto& transition : Y_Z) {
+	for (int id = 0; id < states.capacity(); ++id) {
+		if (!states.is_live(id) || !states.get(id)->is_Y_ICS()) continue;
+		ICS_STATE* ics_state = states.get(id);
 		os << "\tY-ICS State: {{"
-		   << get_subset_string(transition.first->get_nbs()->IS, fsm->states)
-		   << "}," << fsm->states.get_key(transition.first->get_state()) << ','
-		   << transition.first->get_transient_index() << "}\n"
-		   << (transition.second.empty() ? "" : "\tTransitions to:\n");
-		for (auto& pair : transition.second)
+		   << get_subset_string(ics_state->get_nbs()->IS, fsm->states)
+		   << "}," << fsm->states.get_key(ics_state->get_state()) << ','
+		   << ics_state->get_transient_index() << "}\n"
+		   << (children[id].empty() ? "" : "\tTransitions to:\n");
+		for (ICS_Link& link : children[id]) {
+			ICS_STATE* child = states.get(link.child);
 			os << "\t\tZ-ICS State {{"
-		   	   << get_subset_string(pair.second->get_nbs()->IS, fsm->states)
-			   << "}," << fsm->states.get_key(pair.second->get_state()) << ','
-			   << pair.second->get_transient_index()
+		   	   << get_subset_string(child->get_nbs()->IS, fsm->states)
+			   << "}," << fsm->states.get_key(child->get_state()) << ','
+			   << child->get_transient_index()
 			   << "} via Control Decision {"
-			   << get_subset_string(pair.first, fsm->events) << "}\n";
+			   << get_subset_string(NBAIC_State::CDs[link.control], fsm->events) << "}\n";
+		}
 		os << '\n';
 	}
 	os << "Z-States:\n";
-	for (auto& transition : Z_YZ) {
+	for (int id = 0; id < states.capacity(); ++id) {
+		if (!states.is_live(id) || states.get(id)->is_Y_ICS()) continue;
+		ICS_STATE* ics_state = states.get(id);
 		os << "\tZ-ICS State: {{"
-		   << get_subset_string(transition.first->get_nbs()->IS, fsm->states)
-		   << "}," << fsm->states.get_key(transition.first->get_state()) << ','
-		   << transition.first->get_transient_index() << "}\n"
-		   << (transition.second.empty() ? "" : "\tTransitions to:\n");
-		for (auto& pair : transition.second)
+		   << get_subset_string(ics_state->get_nbs()->IS, fsm->states)
+		   << "}," << fsm->states.get_key(ics_state->get_state()) << ','
+		   << ics_state->get_transient_index() << "}\n"
+		   << (children[id].empty() ? "" : "\tTransitions to:\n");
+		for (ICS_Link& link : children[id]) {
+			ICS_STATE* child = states.get(link.child);
 			os << "\t\tICS State {{"
-			   << get_subset_string(pair.second->get_nbs()->IS, fsm->states)
-			   << "}," << fsm->states.get_key(pair.second->get_state()) << ','
-			   << pair.second->get_transient_index() << "} via Event "
-			   << fsm->events.get_key(pair.first) << "\n";
+			   << get_subset_string(child->get_nbs()->IS, fsm->states)
+			   << "}," << fsm->states.get_key(child->get_state()) << ','
+			   << child->get_transient_index() << "} via Event "
+			   << fsm->events.get_key(link.control) << "\n";
+		}
 		os << '\n';
 	}
 	os << "*******************************************************************\n"
@@ -263,45 +237,89 @@ void ICS::print() {
 }
 
 void ICS::print_fsm(const char* const filename) {
-	ofstream os(filename);
-	os << get_ptr.size() << "\r\n\r\n";
-	for (auto& pair : Y_Z) {
-		print_state(os, pair.first, pair.second.size());
-		for (auto& child_pair : pair.second) {
-			/* Print the event leading to the child state and the child state and
-			consider all CDs to be controllable and observable */
-			os << '{' << get_subset_string(child_pair.first, fsm->events) << "}	";
-			child_pair.second->print_fsm(os, fsm);
-			os << "	c	o" << "\r\n";
-		}
-		os << "\r\n";
-	}
-	for (auto& pair : Z_YZ) {
-		print_state(os, pair.first, pair.second.size());
-		for (auto& child_pair : pair.second) {
-			/* Print the event leading to the child state and the child state and
-			Use the input controllable/observable values for all events */
-			os << fsm->events.get_key(child_pair.first) << "	";
-			child_pair.second->print_fsm(os, fsm);
-			os << '	' << (fsm->controllable[child_pair.first] ? "c" : "uc")
-			   << '	' << (fsm->observable[child_pair.first] ? "o" : "uo")
-			   << "\r\n";
+	Fsm_Writer out(filename, fsm);
+	out << get_ptr.size() << "\r\n\r\n";
+	/* Y-ICS States first, then Z-ICS States */
+	for (int pass = 0; pass < 2; ++pass)
+		for (int id = 0; id < states.capacity(); ++id) {
+			if (!states.is_live(id) || states.get(id)->is_Y_ICS() != (pass == 0))
+				continue;
+			ICS_STATE* ics_state = states.get(id);
+			print_state(out, ics_state, children[id].size());
+			for (ICS_Link& link : children[id]) {
+				if (ics_state->is_Y_ICS())
+					/* Print the event leading to the child state and the child state and
+					consider all CDs to be controllable and observable */
+					out << '{' << CD_Names{link.control} << "}	";
+				else
+					/* Print the event leading to the child state and the child state and
+					Use the input controllable/observable values for all events */
+					out << Event_Name{link.control} << "	";
+				states.get(link.child)->print_fsm(out);
+				if (ics_state->is_Y_ICS()) out << "	c	o" << "\r\n";
+				else
+					out << '	' << (fsm->controllable[link.control] ? "c" : "uc")
+						<< '	' << (fsm->observable[link.control] ? "o" : "uo")
+						<< "\r\n";
+			}
+			out << "\r\n";
 		}
-		os << "\r\n";
-	}
-	os.close();
 }
 
-void ICS::print_state(ostream& os, ICS_STATE* ics_state, int num_transitions) {
+void ICS::print_state(Fsm_Writer& out, ICS_STATE* ics_state, int num_transitions) {
 	/* Print parent state, whether it's a marked Z-state, and # of children */
-	ics_state->print_fsm(os, fsm);
-	os << '	' << (ics_state->is_Y_ICS()
-	   	   		  ? false
-	   	   		  : fsm->marked[ics_state->get_state()])
-	   << '	' << num_transitions << "\r\n";
+	ics_state->print_fsm(out);
+	out << '	' << (ics_state->is_Y_ICS()
+				  ? false
+				  : fsm->marked[ics_state->get_state()])
+		<< '	' << num_transitions << "\r\n";
+}
+
+/* Writes the A_UxG to the screen and/or its .fsm file */
+class A_UxG_Printer : public A_UxG_Visitor {
+public:
+	A_UxG_Printer(FSM* fsm_, ostream& os_, Fsm_Writer& file_out_,
+				  bool write_to_file_, bool write_to_screen_)
+		: fsm(fsm_), os(os_), file_out(file_out_),
+		  write_to_file(write_to_file_), write_to_screen(write_to_screen_) {}
+	void state(NBAIC_State* nbs, STATE s, int transitions, int index);
+	void transition(NBAIC_State* nbs, STATE s, EVENT e,
+					bool is_terminal, int index);
+private:
+	FSM* fsm;
+	ostream& os;
+	Fsm_Writer& file_out;
+	bool write_to_file, write_to_screen;
+};
+
+void A_UxG_Printer::state(NBAIC_State* nbs, STATE s, int transitions, int index) {
+	if (write_to_screen)
+		os << "A_UxG State {{" << get_subset_string(nbs->IS, fsm->states)
+		   << "}," << fsm->states.get_key(s) << ',' << index << '}' << (fsm->marked[s] ? " m" : "")
+		   << '\n' << (transitions ? "\tTransitions to:\n" : "");
+	if (write_to_file)
+		file_out << "\r\n{{" << IS_Names{nbs}
+	   			<< "}," << State_Name{s} << ',' << index << "}	"
+	   			<< (fsm->marked[s] ? "1	" : "0	") << transitions << "\r\n";
 }
 
-void ICS::print_A_UxG(UBTS& ubts, ofstream& file_out,
+void A_UxG_Printer::transition(NBAIC_State* nbs, STATE s, EVENT e,
+							   bool is_terminal, int index) {
+	if (write_to_screen)
+		os << "\t\tA_UxG State {{" << get_subset_string(nbs->IS, fsm->states)
+	       << "}," << fsm->states.get_key(s) << ','
+	       << (is_terminal ? 0 : index) << "} via Event "
+	       << fsm->events.get_key(e) << "\n";
+    if (write_to_file)
+    	file_out << Event_Name{e} << "	{{"
+    			 << IS_Names{nbs}
+		         << "}," << State_Name{s} << ','
+		         << (is_terminal ? 0 : index) << "}	"
+		         << (fsm->controllable[e] ? "c	" : "uc	")
+		         << (fsm->observable[e] ? "o" : "uo") << "\r\n";
+}
+
+void ICS::print_A_UxG(UBTS& ubts, Fsm_Writer& file_out,
 					  bool write_to_file, bool write_to_screen) {
 	if (!(write_to_screen || write_to_file)) return;
 	if (write_to_screen)
@@ -309,119 +327,275 @@ void ICS::print_A_UxG(UBTS& ubts, ofstream& file_out,
 		   << "******************Controlled Language Automaton********************\n"
 		   << "*******************************************************************\n";
 	if (write_to_file) file_out << get_A_UxG_size() << "\r\n";
-	unordered_map<ICS_STATE*, int> ics_index = create_ics_index();
-	vector<bool> visited(ics_index.size());
-	/* Start at root ICS_STATE {{0},0} */
-	ICS_STATE* root_ics = get_root();
-	Node<ICS_STATE*>* root = new Node<ICS_STATE*>(root_ics);
-	stack<Node<ICS_STATE*>*> DFS;
-	DFS.push(root);
-	while (!DFS.empty()) {
-		Node<ICS_STATE*>* current = DFS.top();
-		DFS.pop();
-		/* Prevent infinite loops */
-		if (visited[ics_index[current->val]]) continue;
-		visited[ics_index[current->val]] = true;
-		/* Handle all Z-States up to next Y-States */
-		print_A_UxG_helper(ubts, DFS, current, visited, ics_index,
-						   file_out, write_to_file, write_to_screen);
-	}
-	reset_tree(root);
+	A_UxG_Printer printer(fsm, os, file_out, write_to_file, write_to_screen);
+	walk_A_UxG(ubts, printer);
 	if (write_to_screen)
 		os << "*******************************************************************\n"
 	   	   << "*****************End Controlled Language Automaton*****************\n"
 	   	   << "*******************************************************************\n";
 }
 
-void ICS::reduce_A_UxG(const char* file_in, const char* file_out) {
-	FSM A_UxG_FSM(file_in);
-	ofstream os(file_out);
-	A_UxG_FSM.reduce(os);
-	os.close();
+/* Numbers the A_UxG states and transitions in the order the .fsm reader
+would meet them in A_UxG.fsm, so the reduced A_UxG comes out the same as
+reducing a copy read back from that file */
+class A_UxG_Reducer : public A_UxG_Visitor {
+public:
+	A_UxG_Reducer(FSM* fsm_)
+		: fsm(fsm_), current(-1), event_ids(fsm_->nevents, -1),
+		  scaled_ids(fsm_->nstates, -1) {}
+	void state(NBAIC_State* nbs, STATE s, int transitions, int index);
+	void transition(NBAIC_State* nbs, STATE s, EVENT e,
+					bool is_terminal, int index);
+	void print(const char* const filename, int nstates);
+private:
+	int get_id(NBAIC_State* nbs, STATE s, int index);
+	int get_scaled_id(STATE s);
+	void print_state(Fsm_Writer& out, int id);
+	FSM* fsm;
+	int current; /* A_UxG state whose transitions are being visited */
+	/* A_UxG states by id, indexed by A_UxG_hash */
+	unordered_multimap<size_t, int> index;
+	vector<NBAIC_State*> nbs_of;
+	vector<STATE> state_of;
+	vector<int> index_of;
+	vector<bool> marked;
+	vector<unordered_map<EVENT, int>> transitions;
+	/* A_UxG event ids by FSM event, and FSM events by A_UxG event id */
+	vector<EVENT> event_ids;
+	vector<EVENT> events;
+	/* FSM states share primes when the reduced names of their A_UxG
+	states are the same; scaled ids number those names */
+	vector<int> scaled_ids;
+	vector<string> scaled_names;
+	unordered_map<string, int> scaler;
+	vector<int> primes; /* by A_UxG state, -1 until printed */
+	vector<int> state_count; /* primes handed out per scaled id */
+};
+
+static size_t A_UxG_hash(NBAIC_State* nbs, STATE s, int index);
+
+void A_UxG_Reducer::state(NBAIC_State* nbs, STATE s, int transitions, int index) {
+	current = get_id(nbs, s, index);
+	marked[current] = fsm->marked[s];
+}
+
+void A_UxG_Reducer::transition(NBAIC_State* nbs, STATE s, EVENT e,
+							   bool is_terminal, int index) {
+	int child = get_id(nbs, s, is_terminal ? 0 : index);
+	if (event_ids[e] == -1) {
+		event_ids[e] = events.size();
+		events.push_back(e);
+	}
+	transitions[current][event_ids[e]] = child;
+}
+
+int A_UxG_Reducer::get_id(NBAIC_State* nbs, STATE s, int index_) {
+	size_t key = A_UxG_hash(nbs, s, index_);
+	auto range = index.equal_range(key);
+	for (auto iter = range.first; iter != range.second; ++iter) {
+		int id = iter->second;
+		if (nbs_of[id] == nbs && state_of[id] == s && index_of[id] == index_)
+			return id;
+	}
+	int id = nbs_of.size();
+	index.insert(make_pair(key, id));
+	nbs_of.push_back(nbs);
+	state_of.push_back(s);
+	index_of.push_back(index_);
+	marked.push_back(false);
+	transitions.emplace_back();
+	primes.push_back(-1);
+	return id;
+}
+
+/* The reduced name of an A_UxG state is the part of its FSM state's name
+after the last comma not enclosed in (), {} or [] */
+int A_UxG_Reducer::get_scaled_id(STATE s) {
+	if (scaled_ids[s] != -1) return scaled_ids[s];
+	const string& name = fsm->states.get_key(s);
+	int num_paren = 0, num_braces = 0, num_bracket = 0;
+	size_t start = name.size();
+	for (; start > 0; --start) {
+		char current = name[start - 1];
+		if (current == ',' && num_paren == 0 &&
+			num_bracket == 0 && num_braces == 0) break;
+		else if (current == '(') --num_paren;
+		else if (current == '{') --num_braces;
+		else if (current == '[') --num_bracket;
+		else if (current == ')') ++num_paren;
+		else if (current == '}') ++num_braces;
+		else if (current == ']') ++num_bracket;
+	}
+	auto found = scaler.find(name.substr(start));
+	if (found == scaler.end()) {
+		found = scaler.insert(make_pair(name.substr(start), scaled_names.size())).first;
+		scaled_names.push_back(found->first);
+		state_count.push_back(0);
+	}
+	return scaled_ids[s] = found->second;
+}
+
+void A_UxG_Reducer::print_state(Fsm_Writer& out, int id) {
+	int scaled = get_scaled_id(state_of[id]);
+	if (primes[id] == -1) primes[id] = state_count[scaled]++;
+	out << scaled_names[scaled];
+	for (int i = 0; i < primes[id]; ++i) out << '\'';
+}
+
+void A_UxG_Reducer::print(const char* const filename, int nstates) {
+	Fsm_Writer out(filename, fsm);
+	out << nstates << "\r\n\r\n";
+	for (int id = 0; id < (int) nbs_of.size(); ++id) {
+		print_state(out, id);
+		out << "	" << marked[id] << "	" << transitions[id].size() << "\r\n";
+		for (auto& pair : transitions[id]) {
+			EVENT e = events[pair.first];
+			out << Event_Name{e} << "	";
+			print_state(out, pair.second);
+			out << "	" << (fsm->controllable[e] ? "c" : "uc") << "	"
+				<< (fsm->observable[e] ? "o" : "uo") << "\r\n";
+		}
+		out << "\r\n";
+	}
+}
+
+/* Reduce the A_UxG to a more compact and readable form: each state is
+named by its FSM state, with primes telling apart the A_UxG states that
+share one */
+void ICS::reduce_A_UxG(UBTS& ubts, const char* const filename) {
+	A_UxG_Reducer reducer(fsm);
+	walk_A_UxG(ubts, reducer);
+	reducer.print(filename, get_A_UxG_size());
 }
 
+static size_t A_UxG_hash(NBAIC_State* nbs, STATE s, int index) {
+	return hash<NBAIC_State*>()(nbs) ^ (hash<STATE>()(s) * 31)
+		   ^ (hash<int>()(index) * 961);
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
 
 void ICS::delete_memory() {
 	/* Clean up dynamic memory */
-	for (auto& pair : get_ptr)
-		delete pair.second;
-	/* Clean up unordered maps */
-	Y_Z.clear();
-	Z_YZ.clear();
-	reverse.clear();
+	get_ptr.clear();
+	states.clear();
+	coaccessible.clear();
+	stale.clear();
+	/* Clean up links */
+	children.clear();
+	parents.clear();
+}
+
+void ICS::move_memory(ICS& other) {
+	/* Take other's states and links, leaving it with our empty ones */
+	fsm = other.fsm;
+	get_ptr.swap(other.get_ptr);
+	states.swap(other.states);
+	children.swap(other.children);
+	parents.swap(other.parents);
+	coaccessible.swap(other.coaccessible);
+	stale.swap(other.stale);
+	terminal_state = other.terminal_state;
+	root_ics = other.root_ics;
+	other.terminal_state = other.root_ics = nullptr;
 }
 
 void ICS::copy_memory(const ICS& other) {
 	/* Memory not handled dynamically by ICS */
 	fsm = other.fsm;
-	/* Allocate new states to avoid double pointers */
+	/* Allocate new states to avoid double pointers. The copies are
+	given new ids, so new_id translates other's ids to ours */
+	vector<int> new_id(other.states.capacity(), -1);
 	for (auto& pair : other.get_ptr) {
-		get_ptr[pair.first] = new ICS_STATE(pair.first);
-		if (other.terminal_state == pair.second)
-			terminal_state = get_ptr[pair.first];
-		if (other.root_ics == pair.second)
-			root_ics = get_ptr[pair.first];
-		get_ptr[pair.first]->set_disambiguation_state(pair.second->get_disambiguation_state());
+		ICS_STATE* copy = states.create(*pair.second);
+		get_ptr[pair.first] = copy;
+		new_id[pair.second->id] = copy->id;
+		if (other.terminal_state == pair.second) terminal_state = copy;
+		if (other.root_ics == pair.second) root_ics = copy;
 	}
-	/* Use newly allocated states to fill transitions from Y states */
-	for (auto& pair : other.Y_Z) {
-		unordered_map<CONTROL_DECISION, ICS_STATE*> transition;
-		for (auto& other_transition : pair.second)
-			transition[other_transition.first] = get_ptr[*(other_transition.second)];
-		Y_Z[get_ptr[*(pair.first)]] = transition;
+	children.assign(states.capacity(), vector<ICS_Link>());
+	parents.assign(states.capacity(), vector<int>());
+	coaccessible.assign(states.capacity(), false);
+	/* Use the new ids to fill links to children and parents */
+	for (int id = 0; id < other.states.capacity(); ++id) {
+		if (new_id[id] < 0) continue;
+		for (const ICS_Link& link : other.children[id])
+			children[new_id[id]].push_back({link.control, new_id[link.child]});
+		for (int parent : other.parents[id])
+			parents[new_id[id]].push_back(new_id[parent]);
+		coaccessible[new_id[id]] = other.coaccessible[id];
 	}
-	/* Use newly allocated states to fill transitions from Z states */
-	for (auto& pair : other.Z_YZ) {
-		unordered_map<EVENT, ICS_STATE*> transition;
-		for (auto& other_transition : pair.second)
-			transition[other_transition.first] = get_ptr[*(other_transition.second)];
-		Z_YZ[get_ptr[*(pair.first)]] = transition;
-	}
-	/* Use newly allocated states to create links to parents */
-	for (auto& pair : other.reverse) {
-		vector<ICS_STATE*> parents;
-		for (ICS_STATE* ics_state : pair.second)
-			parents.push_back(get_ptr[*ics_state]);
-		reverse[get_ptr[*(pair.first)]] = parents;
+	for (int id : other.stale)
+		if (id < new_id.size() && new_id[id] >= 0) stale.push_back(new_id[id]);
+}
+
+void ICS::push_Y_UBTS(Y_UBTS* y_ubts) {
+	if (y_ubts->child)
+		push(y_ubts->get_YS(), y_ubts->child->get_ZS(),
+			 y_ubts->child->CD, y_ubts->num_predecessors,
+			 y_ubts->child->num_predecessors,
+			 y_ubts->disambiguation_state);
+	else {
+		YS* ys = y_ubts->get_YS();
+		for (STATE s = ys->IS.find_first(); s != Bitset::npos;
+			 s = ys->IS.find_next(s)) {
+			ICS_STATE* y_ics = get_ICS_STATE(y_ubts->nbs, s,
+											 y_ubts->num_predecessors);
+			ICS_STATE* y_ics_0 = get_ICS_STATE(y_ubts->nbs, s);
+			children[y_ics->id] = children[y_ics_0->id];
+			for (ICS_Link& link : children[y_ics->id])
+				link_parent(y_ics, states.get(link.child));
+			y_ics->set_disambiguation_state(y_ics_0->get_disambiguation_state());
+			terminal_state = y_ics;
+		}
 	}
 }
 
+void ICS::push_Z_UBTS(Z_UBTS* z_ubts) {
+	/* Add transitions from Z_UBTS states to Z_UBTS states*/
+	push_internal_transitions(z_ubts->get_ZS(), z_ubts->get_CD(),
+							  z_ubts->num_predecessors);
+	/* Add transitions from Z_UBTS states to Y_UBTS states*/
+	for (auto& pair : z_ubts->children)
+		if (z_ubts->get_CD()[pair.first] || !fsm->controllable.at(pair.first))
+			push_external_transitions(z_ubts->get_ZS(),
+									  pair.second->get_YS(), pair.first,
+									  z_ubts->num_predecessors,
+									  pair.second->num_predecessors,
+									  pair.second->disambiguation_state);
+}
+
 ICS_STATE* ICS::get_ICS_STATE(NBAIC_State* nbs, STATE s, int index /*= 0*/) {
-	ICS_STATE* ics_state = new ICS_STATE(nbs, s, index);
+	ICS_STATE key(nbs, s, index);
+	ICS_STATE*& result = get_ptr[key];
 	/* No matching ICS_State in ICS--create a new one */
-	if (get_ptr.find(*ics_state) == get_ptr.end()) {
-		get_ptr[*ics_state] = ics_state;
-		return ics_state;
-	}
-	/* ICS_STATE match found--delete our
-	temporary and return the existing state */
-	else {
-		ICS_STATE* result = get_ptr[*ics_state];
-		delete ics_state;
-		return result;
+	if (!result) {
+		result = states.create(key);
+		/* A reused slot was left without links by pop */
+		coaccessible.resize(states.capacity());
+		children.resize(states.capacity());
+		parents.resize(states.capacity());
+		coaccessible[result->id] = false;
 	}
+	return result;
 }
 
-void ICS::push_internal_transitions(ZS* zs, CONTROL_DECISION CD,
+void ICS::push_internal_transitions(ZS* zs, const CONTROL_DECISION& CD,
 									int index /*= 0*/,
 									UBTS_State* disambiguation_state /* = nullptr */) {
 	/* For all pairs (i, j) s.t. i, j exist in the information state
 	of the Z-State */
-	for (STATE i = 0; i < zs->IS.size(); ++i) {
-		if (!zs->IS[i]) continue;
-		for (STATE j = 0; j < zs->IS.size(); ++j) {
-			if (!zs->IS[j]) continue;
-			/* For each FSM transition from state i */
-			for (auto transition : fsm->transitions[i])
-				/* i transitions to j in the FSM via an allowed event */
-				if (j == transition.second
-					&& (CD[transition.first]
-						|| !fsm->controllable[transition.first]))
-					push_helper(zs, i, zs, j, Z_YZ,
-								transition.first, index, index);
+	const INFO_STATE& IS = zs->IS;
+	for (STATE i = IS.find_first(); i != Bitset::npos; i = IS.find_next(i)) {
+		/* For each FSM transition from state i */
+		for (int t = fsm->packed_offset[i]; t < fsm->packed_offset[i + 1]; ++t) {
+			EVENT e = fsm->packed_event[t];
+			STATE j = fsm->packed_state[t];
+			/* i transitions to j within the information state
+			via an allowed event */
+			if (IS[j] && (CD[e] || !fsm->controllable[e]))
+				push_helper(zs, i, zs, j, e, index, index);
 		}
 	}
 }
@@ -432,23 +606,17 @@ void ICS::push_external_transitions(ZS* zs, YS* ys, EVENT e,
 									UBTS_State* disambiguation_state /* = nullptr */) {
 	/* For all pairs (i, j) s.t. i exists in the information state
 	of the Z-State and j exists in the information state of the Y-State */
-	for (STATE i = 0; i < zs->IS.size(); ++i) {
-		if (!zs->IS[i]) continue;
-		for (STATE j = 0; j < ys->IS.size(); ++j) {
-			if (!ys->IS[j]) continue;
-			/* i transitions to j via event e */
-			auto& i_map = fsm->transitions[i];
-			if (i_map.find(e) != i_map.end() && i_map[e] == j)
-				push_helper(zs, i, ys, j, Z_YZ, e, parent_index,
-							child_index, disambiguation_state);
-		}
+	for (STATE i = zs->IS.find_first(); i != Bitset::npos; i = zs->IS.find_next(i)) {
+		/* i transitions to j via event e */
+		STATE j = fsm->get_next(i, e);
+		if (j >= 0 && ys->IS[j])
+			push_helper(zs, i, ys, j, e, parent_index,
+						child_index, disambiguation_state);
 	}
 }
 
-template <typename ICS_MAP, typename CONTROL>
 void ICS::push_helper(NBAIC_State* nbs_key, STATE s_key,
-					  NBAIC_State* nbs_val, STATE s_val,
-					  ICS_MAP& ics_map, CONTROL& control,
+					  NBAIC_State* nbs_val, STATE s_val, int control,
 					  int index_key /*= 0*/, int index_val /*= 0*/,
 					  UBTS_State* disambiguation_state /* = nullptr */) {
 	ICS_STATE* key = get_ICS_STATE(nbs_key, s_key, index_key);
@@ -458,164 +626,182 @@ void ICS::push_helper(NBAIC_State* nbs_key, STATE s_key,
 		if (key->is_Y_ICS()) key->set_disambiguation_state(disambiguation_state);
 		else if (val->is_Y_ICS()) val->set_disambiguation_state(disambiguation_state);
 	}
-	/* Create link to child */
-	ics_map[key][control] = val;
+	/* Create link to child, replacing any link with the same control */
+	vector<ICS_Link>& links = children[key->id];
+	auto link = find_if(links.begin(), links.end(),
+						[control](const ICS_Link& l) { return l.control == control; });
+	if (link == links.end()) links.push_back({control, val->id});
+	else if (link->child != val->id) {
+		int replaced = link->child;
+		link->child = val->id;
+		if (!links_to(key->id, replaced)) unlink_parent(key->id, replaced);
+		/* Replacing a link may take away key's path to a marked state */
+		stale.push_back(key->id);
+	}
+	link_parent(key, val);
+}
+
+/* Records parent in child's parents after a link from parent to
+child is created */
+void ICS::link_parent(ICS_STATE* parent, ICS_STATE* child) {
 	/* Create child's link to parent */
-	vector<ICS_STATE*>& vec = reverse[val];
-	if (find(vec.begin(), vec.end(), key) == vec.end()) vec.push_back(key);
+	vector<int>& vec = parents[child->id];
+	if (find(vec.begin(), vec.end(), parent->id) == vec.end())
+		vec.push_back(parent->id);
+	/* A link to a marked or coaccessible state makes parent coaccessible */
+	if (child->is_marked(fsm) || coaccessible[child->id])
+		mark_coaccessible(parent->id);
 }
 
-void ICS::delete_child_link(ICS_STATE* child, ICS_STATE* parent) {
-	/* Find vector iterator matching parent in the child's vector */
-	auto link_to_parent = find(reverse[child].begin(),
-							   reverse[child].end(), parent);
-	if (link_to_parent != reverse[child].end())
-		reverse[child].erase(link_to_parent);
+/* Removes parent from child's parents once no link between them is left */
+void ICS::unlink_parent(int parent, int child) {
+	vector<int>& vec = parents[child];
+	auto link_to_parent = find(vec.begin(), vec.end(), parent);
+	if (link_to_parent != vec.end()) vec.erase(link_to_parent);
 }
 
-template <typename LINK, typename ICS_MAP>
-void ICS::delete_parent_link(LINK link_to_child, ICS_MAP& ics_map,
-							 ICS_STATE* parent) {
-	ics_map[parent].erase(link_to_child);
+/* Removes every link out of ics_state */
+void ICS::unlink_children(ICS_STATE* ics_state) {
+	int id = ics_state->id;
+	if (children[id].empty()) return;
+	for (ICS_Link& link : children[id]) unlink_parent(id, link.child);
+	children[id].clear();
+	stale.push_back(id);
 }
 
-template <typename CONTROL>
-CONTROL ICS::find_link(unordered_map<CONTROL, ICS_STATE*,
-					   hash<CONTROL>>& ics_map, ICS_STATE* ics_state) const {
-	/* Return the key used to access the child ptr from the parent's map */
-	for (auto& pair : ics_map)
-		if (pair.second == ics_state) return pair.first;
+bool ICS::links_to(int parent, int child) const {
+	for (const ICS_Link& link : children[parent])
+		if (link.child == child) return true;
+	return false;
 }
 
-void ICS::livelock_BFS(queue<Node<ICS_STATE*>*>& BFS, Node<ICS_STATE*>* root,
-					   vector<bool>& coaccessible, vector<bool>& visited,
-					   unordered_map<ICS_STATE*, int>& ics_index) {
+/* Flags, by id, every ICS_STATE reachable from the root */
+vector<bool> ICS::find_reachable() {
+	vector<bool> reachable(states.capacity(), false);
+	if (!get_root()) return reachable;
+	Ring_Queue<int> BFS; /* Breadth first search */
+	BFS.push(get_root()->id);
+	reachable[get_root()->id] = true;
 	while (!BFS.empty()) {
-		Node<ICS_STATE*>* current = BFS.front();
+		int current = BFS.front();
 		BFS.pop();
-		/* Prevent infinite loops */
-		if (visited[ics_index[current->val]]) continue;
-		visited[ics_index[current->val]] = true;
-
-		if (current->val->is_Y_ICS()) /* Y_ICS States */
-			check_state_livelock(BFS, current, Y_Z,
-								 coaccessible, visited, ics_index);
-		else /* Z_ICS States */
-			check_state_livelock(BFS, current, Z_YZ,
-								 coaccessible, visited, ics_index);
-		/* BFS found a path to a marked state--go to next state */
-		if (coaccessible[ics_index[root->val]]) break;
+		/* Add children to queue */
+		for (ICS_Link& link : children[current])
+			if (!reachable[link.child]) {
+				reachable[link.child] = true;
+				BFS.push(link.child);
+			}
 	}
+	return reachable;
 }
 
-template <typename ICS_MAP>
-void ICS::check_state_livelock(queue<Node<ICS_STATE*>*>& BFS,
-							   Node<ICS_STATE*>* current,
-							   ICS_MAP& ics_map, vector<bool>& coaccessible,
-							   vector<bool>& visited,
-							   unordered_map<ICS_STATE*, int>& ics_index) {
-	for (auto& pair : ics_map[current->val]) {
-		Node<ICS_STATE*>* next = new Node<ICS_STATE*>(pair.second);
-		next->prev = current;
-		current->next.push_back(next);
-		/* We reached either a coaccessible Y-state or a marked Z-state,
-		 so our state path must be coaccessible */
-		if ((next->val->is_Y_ICS() && coaccessible[ics_index[next->val]])
-			|| (!next->val->is_Y_ICS() && next->val->is_marked(fsm)))
-			record_path(coaccessible, current, ics_index);
-		/* Unmarked state not yet determined to be coaccessible--keep going */
-		else BFS.push(next);
+/* Marks the ICS_STATE with this id coaccessible along with every state
+that reaches it */
+void ICS::mark_coaccessible(int id) {
+	if (coaccessible[id]) return;
+	coaccessible[id] = true;
+	vector<int> DFS(1, id); /* Depth First Search */
+	while (!DFS.empty()) {
+		int current = DFS.back();
+		DFS.pop_back();
+		for (int parent : parents[current])
+			if (!coaccessible[parent]) {
+				coaccessible[parent] = true;
+				DFS.push_back(parent);
+			}
 	}
 }
 
-/* Map each Y-ICS State to a unique int */
-unordered_map<ICS_STATE*, int> ICS::create_ics_index() {
-	unordered_map<ICS_STATE*, int> ics_index;
-	int count = 0;
-	if (!get_root()) return ics_index;
-	Node<ICS_STATE*>* root = new Node<ICS_STATE*>(get_root());
-	queue<Node<ICS_STATE*>*> BFS; /* Breadth first search */
-	BFS.push(root);
-	while (!BFS.empty()) {
-		Node<ICS_STATE*>* current = BFS.front();
-		BFS.pop();
-		/* Prevent infinite loops & add to map */
-		if (ics_index.find(current->val) != ics_index.end()) continue;
-		ics_index[current->val] = count++;
-		/* Add children to queue */
-		if (current->val->is_Y_ICS()){
-			for (auto& child_pair : Y_Z[current->val])
-				BFS.push(make_child(current, child_pair.second));
+/* Re-evaluates the states queued in stale by pop and by replaced links.
+Each, and every coaccessible state with a path to one, is cleared and then
+restored if it still has a link to a marked or coaccessible state, so the
+work is proportional to the part of the ICS upstream of the change */
+void ICS::update_coaccessible() {
+	vector<int> affected;
+	for (int id : stale)
+		if (states.is_live(id) && coaccessible[id]) {
+			coaccessible[id] = false;
+			affected.push_back(id);
 		}
-		else{
-			for (auto& child_pair : Z_YZ[current->val])
-				BFS.push(make_child(current, child_pair.second));
-		}
-	}
-	return ics_index;
+	stale.clear();
+	for (size_t i = 0; i < affected.size(); ++i)
+		for (int parent : parents[affected[i]])
+			if (coaccessible[parent]) {
+				coaccessible[parent] = false;
+				affected.push_back(parent);
+			}
+	for (int id : affected)
+		if (!coaccessible[id] && has_coaccessible_link(id))
+			mark_coaccessible(id);
 }
 
-ICS_STATE* ICS::find_CELC(unordered_map<ICS_STATE*, int>& ics_index,
-						  vector<bool>& coaccessible, UBTS& ubts) {
+bool ICS::has_coaccessible_link(int id) {
+	for (const ICS_Link& link : children[id])
+		if (coaccessible[link.child]
+			|| states.get(link.child)->is_marked(fsm))
+			return true;
+	return false;
+}
+
+ICS_STATE* ICS::find_CELC(vector<bool>& reachable, UBTS& ubts) {
+	Visited_Set visited(states.capacity());
+	Search_Tree<int> tree;
+	vector<int> DFS; /* Depth First Search */
 	/* For all non-coaccessible Y-States */
-	for (auto iter = Y_Z.begin(); iter != Y_Z.end(); ) {
-		ICS_STATE* ics_state = (*iter++).first;
-		if (coaccessible[ics_index[ics_state]]) continue;
-
-		vector<bool> visited(ics_index.size(), false);
-		Node<ICS_STATE*>* root = new Node<ICS_STATE*>(ics_state);
-		stack<Node<ICS_STATE*>*> DFS; /* Depth First Search */
-		DFS.push(root);
+	for (int id = 0; id < states.capacity(); ++id) {
+		if (!reachable[id] || coaccessible[id]
+			|| !states.get(id)->is_Y_ICS()) continue;
+
+		visited.clear();
+		tree.clear();
+		DFS.assign(1, tree.add(id));
 		while(!DFS.empty()) {
-			Node<ICS_STATE*>* current = DFS.top();
-			DFS.pop();
+			int current = DFS.back();
+			DFS.pop_back();
 			
-			int index = ics_index[current->val];
-			if (current->val->is_Y_ICS()) {
+			int index = tree.val(current);
+			if (states.get(index)->is_Y_ICS()) {
 				/* Second time hitting this Y-State--we must have a cycle of 
 				non-coaccessible states */
-				if (visited[index]) {
+				if (visited.test(index)) {
 					/* Cycle is a CELC--return entrance state */
-					if (ICS_STATE* result = CELC_entrance_state(current, ubts)) {
-						reset_tree(root);
+					if (ICS_STATE* result = CELC_entrance_state(tree, current, ubts))
 						return result;
-					}
-					/* Cycle is not a CELC--continue from closest
-					predecessor with > 1 child */
-					else {
-						backtrack(current);
-						continue;
-					}
+					/* Cycle is not a CELC--continue from the
+					remaining branches */
+					else continue;
 				}
 				/* First time hitting this Y-State */
 				else {
-					visited[index] = true;
-					find_next_state(DFS, current, Y_Z[current->val]);
+					visited.set(index);
+					find_next_state(DFS, tree, current, children[index]);
 				}
 			}
 			else {
-				if (visited[index]) continue;
-				visited[index] = true;
-				find_next_state(DFS, current, Z_YZ[current->val]);
+				if (!visited.insert(index)) continue;
+				find_next_state(DFS, tree, current, children[index]);
 			}
 		}
-		reset_tree(root);
 	}
+	return nullptr;
 }
 
-ICS_STATE* ICS::CELC_entrance_state(Node<ICS_STATE*>* end, UBTS& ubts) {
-	Node<ICS_STATE*>* current = end;
+ICS_STATE* ICS::CELC_entrance_state(Search_Tree<int>& tree, int end,
+									UBTS& ubts) {
+	int current = end;
 	do {
 		/* Check all Y-States in cycle. If one is transitioned to
 		by an observable event then it is the entrance state */
-		if (current->val->is_Y_ICS())
-			for (auto& pair : Z_YZ[current->prev->val])
-				if (pair.second == current->val
-					&& fsm->observable[pair.first]
-					&& ubts.is_terminal_Y_UBTS(current->val))
-					return current->val;
-		current = current->prev;
-	} while (current->prev && current->val != end->val);
+		ICS_STATE* current_state = states.get(tree.val(current));
+		if (current_state->is_Y_ICS())
+			for (ICS_Link& link : children[tree.val(tree.parent(current))])
+				if (link.child == current_state->id
+					&& fsm->observable[link.control]
+					&& ubts.is_terminal_Y_UBTS(current_state))
+					return current_state;
+		current = tree.parent(current);
+	} while (tree.parent(current) != Search_Tree<int>::none
+			 && tree.val(current) != tree.val(end));
 	/* No observable event transitioning to a Y-State--cycle is not a CELC */
 	return nullptr;
 }
@@ -625,60 +811,57 @@ int ICS::get_ICS_size(bool include_Y_ICS /* = true*/,
 	if (!include_Z_ICS && !include_Y_ICS) return 0;
 	/* A_UxG size is equal to number of Z_ICS states */
 	int Y_ICS_count = 0, Z_ICS_count = 0;
-	unordered_map<ICS_STATE*, int> ics_index = create_ics_index();
-	vector<bool> visited(ics_index.size());
-	/* Start at root ICS_STATE {{0},0} */
-	Node<ICS_STATE*>* root = new Node<ICS_STATE*>(get_root());
-	queue<Node<ICS_STATE*>*> BFS; /* Breadth First Search */
-	BFS.push(root);
-	while (!BFS.empty()) {
-		Node<ICS_STATE*>* current = BFS.front();
-		BFS.pop();
-		/* Prevent infinite loops */
-   		if (visited[ics_index[current->val]]) continue;
-   		visited[ics_index[current->val]] = true;
-		/* Push children and increment if Z_ICS */
-		if (current->val->is_Y_ICS()) {
-			++Y_ICS_count;
-			for (auto& child_pair : Y_Z[current->val])
-				BFS.push(make_child(current, child_pair.second));
-		}
-		else {
-			++Z_ICS_count;
-			for (auto& child_pair : Z_YZ[current->val])
-				BFS.push(make_child(current, child_pair.second));
-		}
+	/* Count every state reachable from the root ICS_STATE {{0},0} */
+	vector<bool> reachable = find_reachable();
+	for (int id = 0; id < states.capacity(); ++id) {
+		if (!reachable[id]) continue;
+		if (states.get(id)->is_Y_ICS()) ++Y_ICS_count;
+		else ++Z_ICS_count;
 	}
-	reset_tree(root);
 	return (include_Y_ICS ? Y_ICS_count : 0) + (include_Z_ICS ? Z_ICS_count : 0);
 }
 
 int ICS::get_A_UxG_size() { return get_ICS_size(false); }
 
-void ICS::print_A_UxG_helper(UBTS& ubts, stack<Node<ICS_STATE*>*>& DFS,
-							 Node<ICS_STATE*>* current_ys, vector<bool>& visited,
-							 unordered_map<ICS_STATE*, int>& ics_index,
-							 ofstream& file_out, bool write_to_file,
-							 bool write_to_screen) {
-	vector<Node<ICS_STATE*>*> y_ics_states;
+/* Depth first search of the A_UxG, one Y-State and the Z-States up to the
+next Y-States at a time */
+void ICS::walk_A_UxG(UBTS& ubts, A_UxG_Visitor& visitor) {
+	vector<bool> visited(states.capacity());
+	/* Start at root ICS_STATE {{0},0} */
+	stack<ICS_STATE*> DFS;
+	DFS.push(get_root());
+	while (!DFS.empty()) {
+		ICS_STATE* current = DFS.top();
+		DFS.pop();
+		/* Prevent infinite loops */
+		if (visited[current->id]) continue;
+		visited[current->id] = true;
+		/* Handle all Z-States up to next Y-States */
+		walk_A_UxG_helper(ubts, DFS, current, visited, visitor);
+	}
+}
+
+void ICS::walk_A_UxG_helper(UBTS& ubts, stack<ICS_STATE*>& DFS,
+							ICS_STATE* current_ys, vector<bool>& visited,
+							A_UxG_Visitor& visitor) {
+	vector<ICS_STATE*> y_ics_states;
 	/* Add first layer of Z-States */
-	for (auto& pair : Y_Z[current_ys->val])
-		DFS.push(make_child(current_ys, pair.second));
+	for (ICS_Link& link : children[current_ys->id])
+		DFS.push(states.get(link.child));
 	/* For all Z-States between current Y-State and any subsequent Y-States */
-	while (!DFS.empty() && !DFS.top()->val->is_Y_ICS()) {
-		Node<ICS_STATE*>* current = DFS.top();
+	while (!DFS.empty() && !DFS.top()->is_Y_ICS()) {
+		ICS_STATE* current = DFS.top();
 		DFS.pop();
 		/* Prevent infinite loops */
-   		if (visited[ics_index[current->val]]) continue;
-   		visited[ics_index[current->val]] = true;
-
-   		print_A_UxG_state(current_ys->val->get_nbs(),
-   						  current->val->get_state(),
-   						  Z_YZ[current->val].size(),
-   						  current_ys->val->get_transient_index(),
-   						  file_out, write_to_file, write_to_screen);
-   		for (auto& pair : Z_YZ[current->val]) {
-   			ICS_STATE* child = pair.second;
+   		if (visited[current->id]) continue;
+   		visited[current->id] = true;
+
+   		visitor.state(current_ys->get_nbs(),
+   					  current->get_state(),
+   					  children[current->id].size(),
+   					  current_ys->get_transient_index());
+   		for (ICS_Link& link : children[current->id]) {
+   			ICS_STATE* child = states.get(link.child);
    			if (child->is_Y_ICS()) {
    				NBAIC_State* nbs = child->get_nbs();
    				int next_ics_index = ubts.is_terminal_Y_UBTS(child)
@@ -692,24 +875,20 @@ void ICS::print_A_UxG_helper(UBTS& ubts, stack<Node<ICS_STATE*>*>& DFS,
    					next_ics_index = ds->num_predecessors;
    				}
 	   			/* IS changes to the IS in the NBAIC_STATE of the new Y_ICS */
-		   		print_A_UxG_transition(nbs, child->get_state(),
-		   						 	   pair.first, ubts.is_terminal_Y_UBTS(child),
-		   						 	   next_ics_index,
-		   						 	   file_out, write_to_file,
-		   						 	   write_to_screen);
+		   		visitor.transition(nbs, child->get_state(),
+		   						   link.control, ubts.is_terminal_Y_UBTS(child),
+		   						   next_ics_index);
 		   		/* Save ICS_STATE for later */
    				if (!ubts.is_terminal_Y_UBTS(child) && !ds)
-   					y_ics_states.push_back(make_child(current, child));
+   					y_ics_states.push_back(child);
    			}
    			else {
    				/* IS used is the last seen Y_ICS NBAIC_STATE (i.e., current_ys) */
-		   		print_A_UxG_transition(current_ys->val->get_nbs(),
-		   							   child->get_state(), pair.first, false,
-		   						 	   current_ys->val->get_transient_index(),
-		   						 	   file_out, write_to_file,
-		   						 	   write_to_screen);
+		   		visitor.transition(current_ys->get_nbs(),
+		   						   child->get_state(), link.control, false,
+		   						   current_ys->get_transient_index());
 		   		/* Add next layer of Z-states */
-				DFS.push(make_child(current, child));
+				DFS.push(child);
    			}
    		}
 	}
@@ -717,41 +896,11 @@ void ICS::print_A_UxG_helper(UBTS& ubts, stack<Node<ICS_STATE*>*>& DFS,
 	for (auto& y_ics : y_ics_states) DFS.push(move(y_ics));
 }
 
-void ICS::print_A_UxG_state(NBAIC_State* nbs, STATE s, int transitions,
-							int index, ofstream& file_out,
-							bool write_to_file, bool write_to_screen) {
-	if (write_to_screen)
-		os << "A_UxG State {{" << get_subset_string(nbs->IS, fsm->states)
-		   << "}," << fsm->states.get_key(s) << ',' << index << '}' << (fsm->marked[s] ? " m" : "")
-		   << '\n' << (transitions ? "\tTransitions to:\n" : "");
-	if (write_to_file)
-		file_out << "\r\n{{" << get_subset_string(nbs->IS,fsm->states)
-	   			<< "}," << fsm->states.get_key(s) << ',' << index << "}	"
-	   			<< (fsm->marked[s] ? "1	" : "0	") << transitions << "\r\n";
-}
-
-void ICS::print_A_UxG_transition(NBAIC_State* nbs, STATE s,
-								 EVENT e, bool is_terminal, int index,
-								 ofstream& file_out, bool write_to_file,
-								 bool write_to_screen) {
-	if (write_to_screen)
-		os << "\t\tA_UxG State {{" << get_subset_string(nbs->IS, fsm->states)
-	       << "}," << fsm->states.get_key(s) << ','
-	       << (is_terminal ? 0 : index) << "} via Event "
-	       << fsm->events.get_key(e) << "\n";
-    if (write_to_file)
-    	file_out << fsm->events.get_key(e) << "	{{"
-    			 << get_subset_string(nbs->IS, fsm->states)
-		         << "}," << fsm->states.get_key(s) << ','
-		         << (is_terminal ? 0 : index) << "}	"
-		         << (fsm->controllable[e] ? "c	" : "uc	")
-		         << (fsm->observable[e] ? "o" : "uo") << "\r\n";
-}
-
 bool ICS::is_terminal(ICS_STATE* s) {
 	if (s->get_transient_index() == 0) return false;
-	for (auto& pair : Y_Z[s])
-		if (pair.second->get_transient_index() == 0) return true;
+	for (ICS_Link& link : children[s->id])
+		if (states.get(link.child)->get_transient_index() == 0) return true;
+	return false;
 }
 
 /* Z_ICS state has multiple Y_ICS parents, but we only choose one */
@@ -779,20 +928,14 @@ void ICS_STATE::print(ostream& os) const {
 	os << "\tIndex: " << transient_index << '\n';
 }
 
-void ICS_STATE::print_fsm(ostream& os, FSM* fsm) {
+void ICS_STATE::print_fsm(Fsm_Writer& out) {
 	if (is_Y_ICS())
-		os << "{{" << get_subset_string(get_nbs()->IS, fsm->states) << "},";
+		out << "{{" << IS_Names{get_nbs()} << "},";
 	else {
 		ZS* zs = dynamic_cast<ZS*>(get_nbs());
-		const CONTROL_DECISION* CD = nullptr;
-		for (auto& pair : zs->reverse) {
-			CD = &(pair.first);
-			break;
-		}
-		os << "{{{" << get_subset_string(zs->IS, fsm->states)
-		   << "},{" << get_subset_string(*CD, fsm->events) << "}},";
+		out << "{{{" << IS_Names{zs} << "},{" << CD_Names{zs->CD} << "}},";
 	}
-	os << fsm->states.get_key(get_state()) << ',' << get_transient_index() << '}';
+	out << State_Name{get_state()} << ',' << get_transient_index() << '}';
 }
 
 /* Two ICS_STATEs are equal if they point to the same
@@ -814,55 +957,11 @@ size_t hash<ICS_STATE>::operator()(const ICS_STATE& ics_state) const {
 ///////////////////////////////////////////////////////////////////////////////
 
 
-template <typename BOOL_CONTAINER>
-void record_path(BOOL_CONTAINER& bc, Node<ICS_STATE*>* current,
-				 unordered_map<ICS_STATE*, int>& ics_index) {
-	if (current->val->is_Y_ICS()) bc[ics_index[current->val]] = true;
-	if (!current->prev) return;
-	else record_path(bc, current->prev, ics_index);
-}
-
-template <typename ICS_MAP>
-void find_next_state(stack<Node<ICS_STATE*>*>& DFS, Node<ICS_STATE*>* current,
-					 ICS_MAP& ics_map) {
-	/* No subsequent state exists */
-	if (ics_map.empty()) {
-		if (current->prev) backtrack(current);
-		return;
-	}
-	/* At least one subsequent state exists--add them to the DFS */
-	for (auto& pair : ics_map)
-		push_child_to_stack(DFS, current, new Node<ICS_STATE*>(pair.second));
-}
-
-void push_child_to_stack(stack<Node<ICS_STATE*>*>& DFS,
-						 Node<ICS_STATE*>* parent,
-						 Node<ICS_STATE*>* child) {
-	parent->next.push_back(child);
-	child->prev = parent;
-	DFS.push(child);
+void find_next_state(vector<int>& DFS, Search_Tree<int>& tree, int current,
+					 const vector<ICS_Link>& links) {
+	/* Add any subsequent states to the DFS */
+	for (const ICS_Link& link : links)
+		DFS.push_back(tree.add(link.child, current));
 }
 
-void backtrack(Node<ICS_STATE*>* current) {
-	/* State does not transition--remove state and previous
-	states up to last state with more than one child */
-	do {
-		Node<ICS_STATE*>* prev = current->prev;
-		prev->next.erase(find(prev->next.begin(),
-							  prev->next.end(),
-							  current));
-		delete current;
-		current = prev;
-	} while (current->next.size() == 0 &&
-			 current->prev && current->prev->next.size() == 1);
-}
-
-Node<ICS_STATE*>* make_child(Node<ICS_STATE*>* current, ICS_STATE* child) {
-	Node<ICS_STATE*>* next = new Node<ICS_STATE*>(child);
-	next->prev = current;
-	current->next.push_back(next);
-	return next;
-}
-
-
 ///////////////////////////////////////////////////////////////////////////////
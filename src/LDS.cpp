@@ -15,23 +15,21 @@ LDS::LDS(ostream& os_, NBAIC* nbaic_, ICS_STATE* entrance_state_)
 	ICS_STATE first_predecessor(entrance_state_->get_nbs(),
 								entrance_state_->get_state());
 	entrance_state = ics.get_ptr[first_predecessor];
-	Node<ICS_STATE*>* root = new Node<ICS_STATE*>(entrance_state);
-	queue<Node<ICS_STATE*>*> BFS; /* Breadth First Search */
-	BFS.push(root);
+	Search_Tree<ICS_STATE*> tree;
+	Ring_Queue<int> BFS; /* Breadth First Search */
+	BFS.push(tree.add(entrance_state));
 	while(!BFS.empty()) {
-		Node<ICS_STATE*>* current = BFS.front();
+		int current = BFS.front();
 		BFS.pop();
 		/* Found shortest path to marked state */
-		if (current->val->is_marked(ics.fsm)) {
-			record_path(ics, current);
+		if (tree.val(current)->is_marked(ics.fsm)) {
+			record_path(ics, tree, current);
 			reverse(CDs.begin(), CDs.end());
 			reverse(events.begin(), events.end());
 			break;
 		}
-		if (current->val->is_Y_ICS()) push_children(BFS, ics.Y_Z, current);
-		else push_children(BFS, ics.Z_YZ, current);
+		push_children(BFS, tree, ics, current);
 	}
-	reset_tree(root);
 }
 
 /* Locally maximize all CDs s.t. no superset CD defined for a NBAIC_State
@@ -41,8 +39,8 @@ void LDS::compute_maximal() {
 	for (int i = 0; i < CDs.size(); ++i) {
 		/* Compare CD with all possible candidates defined at current state */
 		for (auto& pair : current_YS->transition) {
-			CONTROL_DECISION candidate = pair.first;
-			if (is_subset(CDs[i], candidate) &&
+			CD_ID candidate = pair.first;
+			if (is_subset(NBAIC_State::CDs[CDs[i]], NBAIC_State::CDs[candidate]) &&
 				(events.empty() || is_LDS(current_YS, candidate, i)))
 				CDs[i] = candidate;
 		}
@@ -60,7 +58,8 @@ void LDS::print() const {
 	while (i < CDs.size() || i < events.size()) {
 		if (i < CDs.size())
 			os << "Control Decision " << i << ": {"
-			   << get_subset_string(CDs[i], nbaic->get_fsm()->events) << "}\n";
+			   << get_subset_string(NBAIC_State::CDs[CDs[i]],
+			   						nbaic->get_fsm()->events) << "}\n";
 		if (i < events.size())
 			os << "Event " << i << ": " <<
 			   nbaic->get_fsm()->events.get_key(events[i]) << '\n';
@@ -75,30 +74,26 @@ void LDS::print() const {
 ///////////////////////////////////////////////////////////////////////////////
 
 
-template <typename ICS_MAP>
-void LDS::push_children(queue<Node<ICS_STATE*>*>& BFS, ICS_MAP& ics_map,
-						Node<ICS_STATE*>* parent) {
-	for (auto& pair : ics_map[parent->val]) {
-		Node<ICS_STATE*>* child = new Node<ICS_STATE*>(pair.second);
-		child->prev = parent;
-		parent->next.push_back(child);
-		BFS.push(child);
-	}
+void LDS::push_children(Ring_Queue<int>& BFS, Search_Tree<ICS_STATE*>& tree,
+						ICS& ics, int parent) {
+	for (ICS_Link& link : ics.children[tree.val(parent)->id])
+		BFS.push(tree.add(ics.states.get(link.child), parent));
 }
 
-void LDS::record_path(ICS& ics, Node<ICS_STATE*>* current) {
-	/* We reached the root */
-	if (!current->prev) return;
-	/* Y_ICS is transitioned to by an observable event */
-	else if (current->val->is_Y_ICS())
-		events.push_back(ics.get_event(current->val, current->prev->val));
-	/* Z_ICS is transitioned to by a Control Decision */
-	else if (current->prev->val->is_Y_ICS())
-		CDs.push_back(ics.get_CD(current->val, current->prev->val));
-	record_path(ics, current->prev);
+void LDS::record_path(ICS& ics, Search_Tree<ICS_STATE*>& tree, int current) {
+	/* Walk back until we reach the root */
+	for (int prev; (prev = tree.parent(current)) != Search_Tree<ICS_STATE*>::none;
+		 current = prev) {
+		/* Y_ICS is transitioned to by an observable event */
+		if (tree.val(current)->is_Y_ICS())
+			events.push_back(ics.get_event(tree.val(current), tree.val(prev)));
+		/* Z_ICS is transitioned to by a Control Decision */
+		else if (tree.val(prev)->is_Y_ICS())
+			CDs.push_back(ics.get_CD(tree.val(current), tree.val(prev)));
+	}
 }
 
-bool LDS::is_LDS(YS* current_YS, CONTROL_DECISION& CD, int index) {
+bool LDS::is_LDS(YS* current_YS, CD_ID CD, int index) {
 	/* current_ZS is result of transitioning using our candidate CD */
 	ZS* current_ZS = current_YS->transition[CD];
 	/* Event events[index] in LDS no longer valid--
@@ -0,0 +1,42 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/Mapped_File.h"
+using namespace std;
+
+Mapped_File::Mapped_File(const string& filename)
+	: data(nullptr), length(0), opened(false), mapped(false) {
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return;
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+		void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr != MAP_FAILED) {
+			data = static_cast<const char*>(addr);
+			length = info.st_size;
+			mapped = true;
+			/* Files are parsed front to back */
+			madvise(addr, length, MADV_SEQUENTIAL);
+		}
+	}
+	/* File cannot be mapped--read it into the buffer instead */
+	if (!mapped) {
+		char chunk[1 << 16];
+		ssize_t n;
+		while ((n = ::read(fd, chunk, sizeof chunk)) > 0)
+			buffer.insert(buffer.end(), chunk, chunk + n);
+		if (n < 0) {
+			close(fd);
+			return;
+		}
+		data = buffer.data();
+		length = buffer.size();
+	}
+	close(fd);
+	opened = true;
+}
+
+Mapped_File::~Mapped_File() {
+	if (mapped) munmap(const_cast<char*>(data), length);
+}
@@ -2,30 +2,28 @@
 #include <numeric>
 #include <cmath>
 #include <stack>
+#include <atomic>
+#include <thread>
 #include "../include/NBAIC.h"
 #include "../include/Utilities.h"
+#include "../include/Fsm_Writer.h"
 using namespace std;
 
 CONTROL_DECISION convert_to_all_events(const CONTROL_DECISION& CD,
 									   const vector<int>& max_CD,
 									   const int nevents);
-bool all_deleted(unordered_map<CONTROL_DECISION, ZS*,
-				 			   hash<CONTROL_DECISION>>& transition);
+bool all_deleted(unordered_map<CD_ID, ZS*>& transition);
 bool exists_deleted(unordered_map<EVENT, YS*>& transition);
-template <typename BOOL_CONTAINER>
-void record_path(BOOL_CONTAINER& bc, Node<STATE>* current);
 bool IS_match(const NBAIC_State* nbs, const INFO_STATE& IS, bool& match);
+size_t ZS_hash(const INFO_STATE& IS, CD_ID CD);
+CONTROL_DECISION get_pset_member(unsigned i, size_t size);
 template <typename NBAIC_MAP>
-void push_children(queue<Node<NBAIC_State*>*>& BFS, 
-				   Node<NBAIC_State*>* parent, NBAIC_MAP& nbaic_map);
-template <typename State_List>
-void mark_deleted_helper(vector<bool>& accessible,
-						 int& index, STATE s, State_List& sl);
+void push_children(Ring_Queue<NBAIC_State*>& BFS, NBAIC_MAP& nbaic_map);
 bool currently_unobservable(FSM* fsm, const SENSING_DECISION& current_SD,
 							const EVENT e);
 bool currently_unobservable(FSM* fsm, const SENSING_DECISION& current_SD,
 							const vector<int>& max_SD, const EVENT e);
-void remove_transition(YS* ys, const SENSING_DECISION* SD);
+void remove_transition(YS* ys, CD_ID SD);
 string get_title(Mode mode, bool print_BDO, bool is_end);
 
 struct Is_Child {
@@ -39,19 +37,24 @@ struct Is_Child {
 
 
 NBAIC::NBAIC(FSM* fsm_, IS_Property* isp_,
-			 ostream& os_, Mode mode_   /*=BSCOPNBMAX*/ )
-	: fsm(fsm_), ISP(isp_), ics(fsm, os_), os(os_), mode(mode_) {
+			 ostream& os_, Mode mode_   /*=BSCOPNBMAX*/,
+			 int nthreads_ /*= 1*/)
+	: fsm(fsm_), ISP(isp_), ics(fsm, os_), os(os_), mode(mode_),
+	  nthreads(max(nthreads_, 1)) {
 	if (fsm->is_invalid(mode)) return;
 	NBAIC_State::nstates = fsm->nstates;
 	NBAIC_State::nevents = fsm->nevents;
 	/* Create initial Y-State */
-	YS* y0 = new YS();
+	YS* y0 = YS_pool.create();
 	y0->IS[0] = true;
 	YSL.push_back(y0);
+	index_state(y0);
 
 	if (mode == BSCOPNBMAX) {
-		DoDFS_BSCOPNBMAX(y0);
+		explore(y0, &NBAIC::evaluate_BSCOPNBMAX);
 		bool root_is_coaccessible = true;
+		/* Each pass deletes every livelocked state at once; pruning
+		their predecessors can expose new ones for the next pass */
 		do {
 			prune();
 			delete_inaccessible();
@@ -59,12 +62,12 @@ NBAIC::NBAIC(FSM* fsm_, IS_Property* isp_,
 		if (!root_is_coaccessible) delete_states();
 	}
 	else if (mode == MPO) {
-		DoDFS_MPO(y0);
+		explore(y0, &NBAIC::evaluate_MPO);
 		prune();
 		delete_inaccessible();
 	}
 	else if (mode == MPRCP){
-		DoDFS_MPRCP(y0);
+		explore(y0, &NBAIC::evaluate_MPRCP);
 		prune();
 		delete_inaccessible();
 	}
@@ -78,142 +81,209 @@ NBAIC::~NBAIC() {
 ///////////////////////////////////////////////////////////////////////////////
 
 
-void NBAIC::DoDFS_BSCOPNBMAX(YS* ys) {
-	vector<int> max_CD = get_max_CD(ys);
-	/* For each member of power set of valid, controllable events */
-	for (unsigned i = 0; i < pow(2, max_CD.size()); ++i) {
-		CONTROL_DECISION current_CD(max_CD.size(), false);
-		unsigned event_pset = i;
-		for (unsigned j = 0; j < sizeof(unsigned) * 8; ++j) {
-			/* First bit is 1 */
-			if (event_pset & (unsigned) 0x1) current_CD[j] = true;
-			/* Shift all bits right */
-			event_pset >>= 1;
-			/* No more one bits */
-			if (event_pset == 0) break;
+/* Builds the NBAIC outward from y0 without recursion. The frontier is cut
+into batches; the mode's evaluation policy runs on every Y-State of a batch
+(spread over nthreads workers), then the results are linked into the NBAIC
+one Y-State at a time in frontier order. Linking is the only step that
+touches shared state, so the NBAIC is the same for any thread count */
+void NBAIC::explore(YS* y0, Evaluate_Policy evaluate) {
+	vector<YS*> frontier(1, y0), discovered;
+	vector<Expansion> expansions;
+	while (!frontier.empty()) {
+		for (size_t begin = 0; begin < frontier.size(); begin += BATCH_SIZE * nthreads) {
+			size_t end = min(frontier.size(), begin + BATCH_SIZE * nthreads);
+			expansions.assign(end - begin, Expansion());
+			evaluate_batch(evaluate, &frontier[begin], end - begin, expansions);
+			for (size_t i = begin; i < end; ++i)
+				link(frontier[i], expansions[i - begin], discovered);
 		}
-		CONTROL_DECISION used_events(max_CD.size(), false);
-		vector<Transition> UR_transitions;
-		INFO_STATE IS = unobservable_reach(ys, current_CD, used_events,
-										   max_CD, UR_transitions);
+		frontier.swap(discovered);
+		discovered.clear();
+	}
+}
 
-		/* Unused event in current_CD || doesn't satisfy IS property || deadlocked */
-		if (redundant(current_CD, used_events) || !(*ISP)(IS)
-			|| is_deadlocked(IS, current_CD, max_CD)) continue;
+/* Evaluates each of the n Y-States starting at ys. Workers claim the next
+unevaluated Y-State from a shared counter, so a worker that drew cheap
+Y-States keeps taking more until the batch is done */
+void NBAIC::evaluate_batch(Evaluate_Policy evaluate, YS* const* ys, size_t n,
+						   vector<Expansion>& expansions) {
+	atomic<size_t> next(0);
+	auto worker = [&]() {
+		for (size_t i = next++; i < n; i = next++)
+			(this->*evaluate)(ys[i], expansions[i]);
+	};
+	size_t nworkers = min(n, (size_t) nthreads);
+	vector<thread> helpers;
+	for (size_t t = 1; t < nworkers; ++t) helpers.push_back(thread(worker));
+	worker();
+	for (thread& helper : helpers) helper.join();
+}
 
-		bool zs_in_ZSL = false;
-		current_CD = convert_to_all_events(current_CD, max_CD, fsm->nevents);
-		ZS* zs = get_ZS(IS, current_CD, zs_in_ZSL);
-		/* Link ys to child zs */
-		ys->transition[current_CD] = zs;
-		/* Link zs to parent ys */
-		zs->reverse[current_CD].push_back(ys);
+/* Power set member i of the valid, controllable events in max_CD */
+CONTROL_DECISION get_pset_member(unsigned i, size_t size) {
+	CONTROL_DECISION CD(size, false);
+	for (unsigned j = 0; i; ++j, i >>= 1)
+		if (i & (unsigned) 0x1) CD[j] = true;
+	return CD;
+}
 
-		ics.push(ys, zs, current_CD);
-		ics.push(zs, (NBAIC_State*&)zs, UR_transitions);
+void NBAIC::evaluate_BSCOPNBMAX(const YS* ys, Expansion& result) {
+	evaluate_lattice(ys, true, result);
+}
 
-		if (!zs_in_ZSL) {
-			ZSL.push_back(zs);
-			/* For all observable, controllable events in control decision */
-			for (EVENT e = 0; e < current_CD.size(); ++e) {
-				vector<Transition> OR_transitions;
-				if (!current_CD[e] || !fsm->observable[e]
-					|| !observable_reach(IS, zs, e, OR_transitions)) continue;
-
-				YS* next_ys = nullptr;
-				if (!ys_in_YSL(next_ys, zs, IS, e, OR_transitions)) {
-					YSL.push_back(next_ys);
-					DoDFS_BSCOPNBMAX(next_ys);
-				}
-			}
-			/* For all observable, uncontrollable events */
-			for (EVENT e = 0; e < fsm->uo.size(); ++e) {
-				vector<Transition> OR_transitions;
-				if (!observable_reach(IS, zs, fsm->uo[e], OR_transitions)) continue;
-
-				YS* next_ys = nullptr;
-				if (!ys_in_YSL(next_ys, zs, IS, fsm->uo[e], OR_transitions)) {
-					YSL.push_back(next_ys);
-					DoDFS_BSCOPNBMAX(next_ys);
-				}
-			}
-		}
-	}
+void NBAIC::evaluate_MPRCP(const YS* ys, Expansion& result) {
+	evaluate_lattice(ys, false, result);
 }
 
-void NBAIC::DoDFS_MPRCP(YS* ys) {
+/* Evaluates each member of the power set of max_CD by walking the subset
+lattice depth first. A child decision adds one event, above any already
+chosen, to its parent, so its unobservable reach only has to be extended
+from the parent's. When the IS property is monotone, a decision that
+violates it is not extended at all, since every decision below it in the
+lattice reaches a superset of its information state. Results are reported
+in the same power set order as a plain enumeration */
+void NBAIC::evaluate_lattice(const YS* ys, bool check_deadlock,
+							 Expansion& result) {
 	vector<int> max_CD = get_max_CD(ys);
-	/* For each member of power set of valid, controllable events */
-	for (unsigned i = 0; i < pow(2, max_CD.size()); ++i) {
-		CONTROL_DECISION current_CD(max_CD.size(), false);
-		unsigned event_pset = i;
-		for (unsigned j = 0; j < sizeof(unsigned) * 8; ++j) {
-			/* First bit is 1 */
-			if (event_pset & (unsigned) 0x1) current_CD[j] = true;
-			/* Shift all bits right */
-			event_pset >>= 1;
-			/* No more one bits */
-			if (event_pset == 0) break;
+	const int n = max_CD.size();
+	/* Unobservable events followed by the reach, before any are enabled */
+	Bitset base_follow(fsm->nevents);
+	for (EVENT e : fsm->uu) base_follow.set(e);
+
+	struct Lattice_Node {
+		unsigned subset; /* members of max_CD in the decision */
+		int next_bit; /* next member to try adding */
+		INFO_STATE reach;
+		Bitset follow;
+	};
+	vector<Lattice_Node> DFS; /* Depth First Search */
+	vector<STATE> frontier;
+	for (STATE s = ys->IS.find_first(); s != Bitset::npos; s = ys->IS.find_next(s))
+		frontier.push_back(s);
+	Lattice_Node root = { 0, 0, INFO_STATE(fsm->nstates), base_follow };
+	close_reach(root.reach, root.follow, frontier);
+
+	vector<unsigned> order;
+	if (!evaluate_decision(root.subset, root.reach, root.follow, max_CD,
+						   check_deadlock, result, order))
+		DFS.push_back(root);
+	while (!DFS.empty()) {
+		if (DFS.back().next_bit == n) {
+			DFS.pop_back();
+			continue;
 		}
-		CONTROL_DECISION used_events(max_CD.size(), false);
-		vector<Transition> UR_transitions;
-		INFO_STATE IS = unobservable_reach(ys, current_CD, used_events,
-										   max_CD, UR_transitions);
-
-		/* Unused event in current_CD || doesn't satisfy IS property*/
-		if (redundant(current_CD, used_events) || !(*ISP)(IS)) continue;
-
-		bool zs_in_ZSL = false;
-		current_CD = convert_to_all_events(current_CD, max_CD, fsm->nevents);
-		ZS* zs = get_ZS(IS, current_CD, zs_in_ZSL);
-		/* Link ys to child zs */
-		ys->transition[current_CD] = zs;
-		/* Link zs to parent ys */
-		zs->reverse[current_CD].push_back(ys);
-		if (!zs_in_ZSL) {
-			ZSL.push_back(zs);
-			/* For all observable, controllable events in control decision */
-			for (EVENT e = 0; e < current_CD.size(); ++e) {
-				vector<Transition> OR_transitions;
-				if (!current_CD[e] || !fsm->observable[e]
-					|| !observable_reach(IS, zs, e, OR_transitions)) continue;
-
-				YS* next_ys = nullptr;
-				if (!ys_in_YSL(next_ys, zs, IS, e, OR_transitions)) {
-					YSL.push_back(next_ys);
-					DoDFS_MPRCP(next_ys);
-				}
-			}
-			/* For all observable, uncontrollable events */
-			for (EVENT e = 0; e < fsm->uo.size(); ++e) {
-				vector<Transition> OR_transitions;
-				if (!observable_reach(IS, zs, fsm->uo[e], OR_transitions)) continue;
-
-				YS* next_ys = nullptr;
-				if (!ys_in_YSL(next_ys, zs, IS, fsm->uo[e], OR_transitions)) {
-					YSL.push_back(next_ys);
-					DoDFS_MPRCP(next_ys);
-				}
+		int j = DFS.back().next_bit++;
+		Lattice_Node child = { DFS.back().subset | (1u << j), j + 1,
+							   DFS.back().reach, DFS.back().follow };
+		/* Observable events are not followed, so they cannot grow the reach */
+		EVENT e = max_CD[j];
+		if (!fsm->observable[e]) {
+			child.follow.set(e);
+			for (STATE s = child.reach.find_first(); s != Bitset::npos;
+				 s = child.reach.find_next(s)) {
+				STATE next = fsm->get_next(s, e);
+				if (next >= 0 && !child.reach[next]) frontier.push_back(next);
 			}
+			close_reach(child.reach, child.follow, frontier);
 		}
+		if (!evaluate_decision(child.subset, child.reach, child.follow, max_CD,
+							   check_deadlock, result, order))
+			DFS.push_back(child);
 	}
+
+	/* Put the accepted decisions back into power set order */
+	vector<int> rank(order.size());
+	iota(rank.begin(), rank.end(), 0);
+	sort(rank.begin(), rank.end(),
+		 [&order](int a, int b) { return order[a] < order[b]; });
+	Expansion sorted;
+	for (int k : rank) {
+		sorted.CDs.push_back(move(result.CDs[k]));
+		sorted.ISs.push_back(move(result.ISs[k]));
+		sorted.UR_transitions.push_back(move(result.UR_transitions[k]));
+	}
+	result = move(sorted);
 }
 
-void NBAIC::DoDFS_MPO(YS* ys) {
-	// print();
+/* Adds the states reachable from frontier through events in follow to
+reach, emptying frontier */
+void NBAIC::close_reach(INFO_STATE& reach, const Bitset& follow,
+						vector<STATE>& frontier) {
+	/* States added to reach whose transitions haven't been followed */
+	INFO_STATE pending(fsm->nstates);
+	/* Add the uncontrollable, unobservable closure of s */
+	auto add_closure = [&](STATE s) {
+		INFO_STATE added = fsm->uu_closure[s];
+		added.and_not(reach);
+		reach |= added;
+		pending |= added;
+	};
+	for (STATE s : frontier)
+		if (!reach[s]) add_closure(s);
+	frontier.clear();
+	/* Pending states are already closed under uncontrollable, unobservable
+	events, so only the controllable ones in follow can add to reach */
+	for (STATE current = pending.find_first(); current != Bitset::npos;
+		 current = pending.find_first()) {
+		pending.reset(current);
+		for (int t = fsm->packed_offset[current];
+			 t < fsm->packed_offset[current + 1]; ++t)
+			if (follow[fsm->packed_event[t]] && !reach[fsm->packed_state[t]])
+				add_closure(fsm->packed_state[t]);
+	}
+}
+
+/* Records the decision if it is valid at a Y-State whose unobservable
+reach under it is IS. Returns true if no decision containing it can
+satisfy the IS property either */
+bool NBAIC::evaluate_decision(unsigned subset, const INFO_STATE& IS,
+							  const Bitset& follow, const vector<int>& max_CD,
+							  bool check_deadlock, Expansion& result,
+							  vector<unsigned>& order) {
+	if (!(*ISP)(IS)) return ISP->is_monotone();
+	CONTROL_DECISION current_CD = get_pset_member(subset, max_CD.size());
+	CONTROL_DECISION all_CD = convert_to_all_events(current_CD, max_CD,
+													fsm->nevents);
+	Reach_Cache::Entry entry;
+	if (!reach_cache.find(IS, all_CD, entry)) {
+		/* Events enabled anywhere in the reach */
+		Bitset enabled(fsm->nevents);
+		for (STATE s = IS.find_first(); s != Bitset::npos; s = IS.find_next(s))
+			enabled |= fsm->enabled_events[s];
+		CONTROL_DECISION used_events(max_CD.size(), false);
+		for (int e = 0; e < max_CD.size(); ++e)
+			if (enabled[max_CD[e]]) used_events[e] = true;
+
+		/* Unused event in current_CD || deadlocked */
+		entry.valid = !redundant(current_CD, used_events)
+			&& !(check_deadlock && is_deadlocked(IS, all_CD));
+
+		/* ICS transition information */
+		if (entry.valid && mode == BSCOPNBMAX)
+			for (STATE s = IS.find_first(); s != Bitset::npos; s = IS.find_next(s))
+				for (int t = fsm->packed_offset[s]; t < fsm->packed_offset[s + 1]; ++t)
+					if (follow[fsm->packed_event[t]])
+						entry.UR_transitions.push_back(
+							Transition(s, fsm->packed_event[t], fsm->packed_state[t]));
+		reach_cache.insert(IS, all_CD, entry);
+	}
+	if (!entry.valid) return false;
+
+	result.CDs.push_back(all_CD);
+	result.ISs.push_back(IS);
+	result.UR_transitions.push_back(entry.UR_transitions);
+	order.push_back(subset);
+	return false;
+}
+
+void NBAIC::evaluate_MPO(const YS* ys, Expansion& result) {
 	vector<int> max_SD = get_max_CD(ys);
 	/* For each member of power set of valid, monitorable events */
 	for (unsigned i = 0; i < pow(2, max_SD.size()); ++i) {
 		SENSING_DECISION current_SD(fsm->nevents, false);
 		unsigned event_pset = i;
-		for (unsigned j = 0; j < sizeof(unsigned) * 8; ++j) {
-			/* First bit is 1 */
+		for (unsigned j = 0; event_pset; ++j, event_pset >>= 1)
 			if (event_pset & (unsigned) 0x1) current_SD[max_SD[j]] = true;
-			/* Shift all bits right */
-			event_pset >>= 1;
-			/* No more one bits */
-			if (event_pset == 0) break;
-		}
 		SENSING_DECISION used_events(fsm->nevents, false);
 		vector<Transition> UR_transitions;
 		INFO_STATE IS = unobservable_reach(ys, current_SD, used_events,
@@ -221,36 +291,68 @@ void NBAIC::DoDFS_MPO(YS* ys) {
 
 		/* Unused event in current_SD || doesn't satisfy IS property || deadlocked */
 		if (redundant(current_SD, used_events) || !(*ISP)(IS)
-			/*|| is_deadlocked(IS, current_SD, max_SD)*/) continue;
+			/*|| is_deadlocked(IS, current_SD)*/) continue;
 
+		result.CDs.push_back(current_SD);
+		result.ISs.push_back(IS);
+		result.UR_transitions.push_back(UR_transitions);
+	}
+}
+
+/* Links ys to the Z-States of its evaluated decisions and each new Z-State
+to its Y-States, recording the Y-States that did not exist yet */
+void NBAIC::link(YS* ys, Expansion& expansion, vector<YS*>& discovered) {
+	for (int k = 0; k < expansion.CDs.size(); ++k) {
+		CONTROL_DECISION& current_CD = expansion.CDs[k];
+		CD_ID CD = NBAIC_State::CDs.intern(current_CD);
+		INFO_STATE& IS = expansion.ISs[k];
 		bool zs_in_ZSL = false;
-		ZS* zs = get_ZS(IS, current_SD, zs_in_ZSL);
+		ZS* zs = get_ZS(IS, CD, zs_in_ZSL);
 		/* Link ys to child zs */
-		ys->transition[current_SD] = zs;
+		ys->transition[CD] = zs;
 		/* Link zs to parent ys */
-		zs->reverse[current_SD].push_back(ys);
+		zs->reverse[CD].push_back(ys);
 
-		if (!zs_in_ZSL) {
-			ZSL.push_back(zs);
+		if (mode == BSCOPNBMAX) {
+			ics.push(ys, zs, CD);
+			ics.push(zs, (NBAIC_State*&)zs, expansion.UR_transitions[k]);
+		}
+		if (zs_in_ZSL) continue;
+		ZSL.push_back(zs);
+		if (mode == MPO) {
 			/* For all observable, non-redundant events */
-			for (EVENT e = 0; e < fsm->nevents; ++e) {
-				vector<Transition> OR_transitions;
-				if (currently_unobservable(fsm, current_SD, e)
-					|| !observable_reach(IS, zs, e, OR_transitions)) continue;
-
-				YS* next_ys = nullptr;
-				if (!ys_in_YSL(next_ys, zs, IS, e, OR_transitions)) {
-					YSL.push_back(next_ys);
-					DoDFS_MPO(next_ys);
-				}
-			}
+			for (EVENT e = 0; e < fsm->nevents; ++e)
+				if (!currently_unobservable(fsm, current_CD, e))
+					link_event(zs, IS, e, discovered);
 		}
+		else {
+			/* For all observable, controllable events in control decision */
+			for (EVENT e = current_CD.find_first(); e != Bitset::npos;
+				 e = current_CD.find_next(e))
+				if (fsm->observable[e]) link_event(zs, IS, e, discovered);
+			/* For all observable, uncontrollable events */
+			for (EVENT e = 0; e < fsm->uo.size(); ++e)
+				link_event(zs, IS, fsm->uo[e], discovered);
+		}
+	}
+}
+
+/* Links zs to the Y-State it reaches via e, if any. IS is overwritten
+with that Y-State's information state */
+void NBAIC::link_event(ZS* zs, INFO_STATE& IS, const EVENT e,
+					   vector<YS*>& discovered) {
+	vector<Transition> OR_transitions;
+	if (!observable_reach(IS, zs, e, OR_transitions)) return;
+
+	YS* next_ys = nullptr;
+	if (!ys_in_YSL(next_ys, zs, IS, e, OR_transitions)) {
+		YSL.push_back(next_ys);
+		discovered.push_back(next_ys);
 	}
 }
 
 void NBAIC::reduce_MPO(bool generate_maximal) {
-	unordered_map<NBAIC_State*, int> YS_index = create_NBAIC_index(true, false);
-	vector<bool> visited(YS_index.size());
+	vector<bool> visited(YS_pool.capacity());
 	queue<YS*> BFS;
 	BFS.push(YSL[0]);
 	while (!BFS.empty()) {
@@ -258,33 +360,35 @@ void NBAIC::reduce_MPO(bool generate_maximal) {
 		BFS.pop();
 
 		/* Only visit each Y-state once */
-		if (visited[YS_index[ys]]) continue;
-		visited[YS_index[ys]] = true;
+		if (visited[ys->id]) continue;
+		visited[ys->id] = true;
 
-		const SENSING_DECISION* greedy_SD = nullptr;
+		CD_ID greedy_SD = -1;
 		/* For each transition defined at the Y-state */
 		auto iter = ys->transition.begin();
 		while (iter != ys->transition.end()) {
 			auto current = iter++;
 			/* Pick first state--if transition is singleton then trivially optimal */
-			if (!greedy_SD) {
-				greedy_SD = &current->first;
+			if (greedy_SD < 0) {
+				greedy_SD = current->first;
 				continue;
 			}
+			const SENSING_DECISION& greedy = NBAIC_State::CDs[greedy_SD];
+			const SENSING_DECISION& candidate = NBAIC_State::CDs[current->first];
 			/* Transition is more optimal based on max/min mode */
-			if ((generate_maximal && is_subset(*greedy_SD, current->first))
-				|| (!generate_maximal && is_subset(current->first, *greedy_SD))) {
+			if ((generate_maximal && is_subset(greedy, candidate))
+				|| (!generate_maximal && is_subset(candidate, greedy))) {
 				remove_transition(ys, greedy_SD);
-				greedy_SD = &current->first;
+				greedy_SD = current->first;
 			}
 			/* Transition is not more optimal and should be deleted */
 			else {
-				remove_transition(ys, &current->first);
+				remove_transition(ys, current->first);
 			}
 		}
 
 		/* Add all children of Z-state to the queue */
-		ZS* zs = ys->transition[*greedy_SD];
+		ZS* zs = ys->transition[greedy_SD];
 		for (auto& pair : zs->transition)
 			BFS.push(pair.second);
 	}
@@ -335,8 +439,8 @@ INFO_STATE NBAIC::unobservable_reach(const YS* ys, const CONTROL_DECISION& CD,
 	queue<STATE> BFS;
 
 	/* Fill BFS with states in current IS */
-	for (STATE s = 0; s < ys->IS.size(); ++s)
-		if (ys->IS[s]) BFS.push(s);
+	for (STATE s = ys->IS.find_first(); s != Bitset::npos; s = ys->IS.find_next(s))
+		BFS.push(s);
 
 	while (!BFS.empty()) {
 		STATE current = BFS.front();
@@ -345,34 +449,35 @@ INFO_STATE NBAIC::unobservable_reach(const YS* ys, const CONTROL_DECISION& CD,
 
 		if (mode != MPO) {
 			/* For all controllable events in control decision */
-			for (EVENT e = 0; e < max_CD.size(); ++e) {
+			for (EVENT e = CD.find_first(); e != Bitset::npos; e = CD.find_next(e)) {
 				/* Event is in CD and is valid for current state */
-				if (CD[e] && fsm->transitions[current].find(max_CD[e])
-						  != fsm->transitions[current].end()) {
-					used_events[e] = true;
-					/* Event is unobservable, so next state must be
-					in unobservable reach */
-					if (!fsm->observable[max_CD[e]])
-						find_next(BFS, result, current, max_CD[e], UR_transitions);
-				}
+				STATE next = fsm->get_next(current, max_CD[e]);
+				if (next < 0) continue;
+				used_events[e] = true;
+				/* Event is unobservable, so next state must be
+				in unobservable reach */
+				if (!fsm->observable[max_CD[e]])
+					find_next(BFS, result, current, max_CD[e], next, UR_transitions);
 			}
 			/* For all uncontrollable, unobservable events */
 			for (EVENT e = 0; e < fsm->uu.size(); ++e) {
 				/* Event is valid for current state */
-				if (fsm->transitions[current].find(fsm->uu[e])
-					!= fsm->transitions[current].end()) {
-					find_next(BFS, result, current, fsm->uu[e], UR_transitions);
-				}
+				STATE next = fsm->get_next(current, fsm->uu[e]);
+				if (next >= 0)
+					find_next(BFS, result, current, fsm->uu[e], next, UR_transitions);
 			}
 		}
 		else if (mode == MPO) {
 			/* For all unobservable events in reach */
-			for (auto& pair : fsm->transitions[current])
+			for (int t = fsm->packed_offset[current];
+				 t < fsm->packed_offset[current + 1]; ++t) {
+				EVENT e = fsm->packed_event[t];
 				/* Event is unobservable and child
 				state hasn't been visited */
-				if (currently_unobservable(fsm, CD, pair.first)
-					&& !result[pair.second]) BFS.push(pair.second);
-				else if (CD[pair.first]) used_events[pair.first] = true;
+				if (currently_unobservable(fsm, CD, e)
+					&& !result[fsm->packed_state[t]]) BFS.push(fsm->packed_state[t]);
+				else if (CD[e]) used_events[e] = true;
+			}
 		}
 	}
 	return result;
@@ -380,14 +485,13 @@ INFO_STATE NBAIC::unobservable_reach(const YS* ys, const CONTROL_DECISION& CD,
 
 bool NBAIC::observable_reach(INFO_STATE& IS, const ZS* zs, const EVENT e,
 						     vector<Transition>& OR_transitions) {
-	fill(IS.begin(), IS.end(), false);
+	IS.reset();
 	bool has_OR = false; /* has Observable Reach */
-	for (STATE s = 0; s < zs->IS.size(); ++s) {
+	for (STATE s = zs->IS.find_first(); s != Bitset::npos; s = zs->IS.find_next(s)) {
 		/* Event is valid for the state in Information State of Z-State */
- 		if (zs->IS[s] && fsm->transitions[s].find(e) !=
- 						 fsm->transitions[s].end()) {
+ 		STATE next = fsm->get_next(s, e);
+ 		if (next >= 0) {
  			/* Add the state that results from the transition */
- 			STATE next = fsm->transitions[s][e];
 			/* Add ICS transition information */
  			if (mode != MPO) {
 	 			Transition transition(s, e, next);
@@ -401,9 +505,8 @@ bool NBAIC::observable_reach(INFO_STATE& IS, const ZS* zs, const EVENT e,
 }
 
 void NBAIC::find_next(queue<STATE>& BFS, const INFO_STATE& result,
-					  const STATE current, const EVENT e,
+					  const STATE current, const EVENT e, const STATE next,
 					  vector<Transition>& UR_transitions) {
-	STATE next = fsm->transitions[current][e];
 	/* Add ICS transition information */
 	if (mode == BSCOPNBMAX) {
 		Transition transition(current, e, next);
@@ -425,8 +528,8 @@ vector<int> NBAIC::get_max_CD(const YS* ys) {
 	queue<STATE> BFS; /* Breadth First Search */
 
 	/* Mark every state in current Y-State as visited */
-	for (STATE s = 0; s < ys->IS.size(); ++s)
-		if (ys->IS[s]) BFS.push(s);
+	for (STATE s = ys->IS.find_first(); s != Bitset::npos; s = ys->IS.find_next(s))
+		BFS.push(s);
 
 	while (!BFS.empty()) {
 		STATE current = BFS.front();
@@ -436,48 +539,52 @@ vector<int> NBAIC::get_max_CD(const YS* ys) {
 		if (visited[current]) continue;
 		visited[current] = true;
 
-		/* Mark each valid event for the state */
-		for (EVENT e = 0; e < CD.size(); ++e) {
-			if (fsm->transitions[current].find(e)
-				!= fsm->transitions[current].end()) {
-				if ((mode != MPO && fsm->controllable[e]) ||
-					(mode == MPO && fsm->monitorable[e])) CD[e] = true;
-				/* Get the next state only if its
-				within the unobservable reach*/
-				if (!fsm->observable[e]) {
-					STATE next = fsm->transitions[current][e];
-					if (!visited[next]) BFS.push(next);
-				}
+		/* Mark each valid event for the state--packed rows are sorted by
+		event, so the search order matches a scan over every event */
+		for (int t = fsm->packed_offset[current];
+			 t < fsm->packed_offset[current + 1]; ++t) {
+			EVENT e = fsm->packed_event[t];
+			if ((mode != MPO && fsm->controllable[e]) ||
+				(mode == MPO && fsm->monitorable[e])) CD[e] = true;
+			/* Get the next state only if its
+			within the unobservable reach*/
+			if (!fsm->observable[e]) {
+				STATE next = fsm->packed_state[t];
+				if (!visited[next]) BFS.push(next);
 			}
 		}
 	}
 	/* Prepare set of integers representing valid
 	events for use in power set */
 	vector<int> result;
-	for (EVENT e = 0; e < CD.size(); ++e)
-		if (CD[e]) result.push_back(e);
+	for (EVENT e = CD.find_first(); e != Bitset::npos; e = CD.find_next(e))
+		result.push_back(e);
 
 	return result;
 }
 
-ZS* NBAIC::get_ZS(const INFO_STATE& IS, const CONTROL_DECISION& CD, bool& zs_in_ZSL) {
-	/* For all Y-States that can transition via CD */
-	for (YS* ys : YSL) {
-		if (ys->transition.find(CD) == ys->transition.end()) continue;
-		ZS* zs = ys->transition[CD];
+ZS* NBAIC::get_ZS(const INFO_STATE& IS, CD_ID CD, bool& zs_in_ZSL) {
+	/* For all Z-States whose IS and CD share a hash with ours */
+	auto range = ZS_index.equal_range(ZS_hash(IS, CD));
+	for (auto iter = range.first; iter != range.second; ++iter)
 		/* Identical Z-State already exists in NBAIC */
-		if (IS_match(zs, IS, zs_in_ZSL)) return zs;
-	}
+		if (iter->second->CD == CD && IS_match(iter->second, IS, zs_in_ZSL))
+			return iter->second;
 	/* No identical Z-State exists in NBAIC--create one */
-	return new ZS(IS, CD);
+	ZS* zs = ZS_pool.create(IS, CD);
+	index_state(zs);
+	return zs;
 }
 
 YS* NBAIC::get_YS(const INFO_STATE& IS, bool& ys_in_YSL) {
-	for (YS* ys : YSL)
+	auto range = YS_index.equal_range(IS.hash());
+	for (auto iter = range.first; iter != range.second; ++iter)
 		/* Identical Y-state already exists in NBAIC */
-		if (IS_match(ys, IS, ys_in_YSL)) return ys;
+		if (IS_match(iter->second, IS, ys_in_YSL)) return iter->second;
 	/* No identical Y-State exists in NBAIC--create one */
-	return new YS(IS);
+	YS* ys = YS_pool.create(IS);
+	index_state(ys);
+	return ys;
 }
 
 bool NBAIC::ys_in_YSL(YS*& ys, ZS* zs, const INFO_STATE& IS, const EVENT e,
@@ -492,12 +599,33 @@ bool NBAIC::ys_in_YSL(YS*& ys, ZS* zs, const INFO_STATE& IS, const EVENT e,
 	return result;
 }
 
-CONTROL_DECISION NBAIC::get_CD(ZS* zs) {
-	for (YS* ys : YSL)
-		for (auto& pair : ys->transition)
-			if (pair.second == zs) return pair.first;
+void NBAIC::index_state(YS* ys) {
+	YS_index.insert(make_pair(ys->IS.hash(), ys));
+}
+
+void NBAIC::index_state(ZS* zs) {
+	ZS_index.insert(make_pair(ZS_hash(zs->IS, zs->CD), zs));
+}
+
+void NBAIC::unindex_state(YS* ys) {
+	auto range = YS_index.equal_range(ys->IS.hash());
+	for (auto iter = range.first; iter != range.second; ++iter)
+		if (iter->second == ys) {
+			YS_index.erase(iter);
+			return;
+		}
 }
 
+void NBAIC::unindex_state(ZS* zs) {
+	auto range = ZS_index.equal_range(ZS_hash(zs->IS, zs->CD));
+	for (auto iter = range.first; iter != range.second; ++iter)
+		if (iter->second == zs) {
+			ZS_index.erase(iter);
+			return;
+		}
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 
@@ -522,7 +650,8 @@ void NBAIC::delete_NBAIC_States(State_List& sl) {
 						  vec.end());
 			}
 			/* Delete current state */
-			delete sl[s];
+			unindex_state(sl[s]);
+			destroy_state(sl[s]);
 			sl[s] = nullptr;
 			++num_deleted;
 		}
@@ -537,59 +666,54 @@ void NBAIC::delete_NBAIC_States(State_List& sl) {
 
 void NBAIC::delete_ICS_State(NBAIC_State* nbs) {
 	/* For all ICS_States corresponding to the NBAIC_State to be deleted */
-	for (STATE s = 0; s < nbs->IS.size(); ++s)
-		if (nbs->IS[s]) ics.pop(nbs, s);
+	for (STATE s = nbs->IS.find_first(); s != Bitset::npos; s = nbs->IS.find_next(s))
+		ics.pop(nbs, s);
 }
 
 void NBAIC::delete_inaccessible() {
 	if (is_empty()) return;
-	unordered_map<NBAIC_State*, int> NBAIC_index = create_NBAIC_index(true, true);
-	vector<bool> accessible(NBAIC_index.size(), false);
+	vector<bool> Y_accessible(YS_pool.capacity(), false);
+	vector<bool> Z_accessible(ZS_pool.capacity(), false);
 
-	queue<Node<NBAIC_State*>*> BFS; /* Breadth First Search */
-	Node<NBAIC_State*>* root = new Node<NBAIC_State*>(YSL[0]);
-	BFS.push(root);
+	Ring_Queue<NBAIC_State*> BFS; /* Breadth First Search */
+	BFS.push(YSL[0]);
 	while(!BFS.empty()) {
-		Node<NBAIC_State*>* current = BFS.front();
+		NBAIC_State* current = BFS.front();
 		BFS.pop();
 
-		int index = NBAIC_index[current->val];
+		vector<bool>& accessible = current->is_YS ? Y_accessible
+												  : Z_accessible;
 		/* Already visited--no need to visit again */
-		if (accessible[index]) continue;
-		accessible[index] = true;
+		if (accessible[current->id]) continue;
+		accessible[current->id] = true;
 		/* Add all accessible children */
-		if (current->val->is_YS) {
-			YS* ys = dynamic_cast<YS*>(current->val);
-			push_children(BFS, current, ys->transition);
-		}
-		else {
-			ZS* zs = dynamic_cast<ZS*>(current->val);
-			push_children(BFS, current, zs->transition);
-		}
+		if (current->is_YS)
+			push_children(BFS, dynamic_cast<YS*>(current)->transition);
+		else
+			push_children(BFS, dynamic_cast<ZS*>(current)->transition);
 	}
-	reset_tree(root);
-	mark_deleted(accessible);
+	mark_deleted(Y_accessible, Z_accessible);
 	delete_NBAIC_States(YSL);
 	delete_NBAIC_States(ZSL);
 }
 
-void NBAIC::mark_deleted(vector<bool>& accessible) {
-	int index = 0;
+void NBAIC::mark_deleted(vector<bool>& Y_accessible,
+						 vector<bool>& Z_accessible) {
 	/* Delete all inaccessible Y-States */
-	while (index < YSL.size())
-		mark_deleted_helper(accessible, index, index, YSL);
-	/* Delete all inaccessible Z-States
-	Note: accessible is partitioned so that the last ZSL.size()
-	states represent the Z-States of the NBAIC */
-	while (index < accessible.size())
-		mark_deleted_helper(accessible, index, index - YSL.size(), ZSL);
+	for (YS* ys : YSL)
+		if (!Y_accessible[ys->id]) ys->deleted = true;
+	/* Delete all inaccessible Z-States */
+	for (ZS* zs : ZSL)
+		if (!Z_accessible[zs->id]) zs->deleted = true;
 }
 
 void NBAIC::delete_states() {
-	for (YS* ys : YSL) delete ys;
-	for (ZS* zs : ZSL) delete zs;
 	YSL.clear();
 	ZSL.clear();
+	YS_pool.clear();
+	ZS_pool.clear();
+	YS_index.clear();
+	ZS_index.clear();
 }
 
 
@@ -600,123 +724,66 @@ void NBAIC::delete_states() {
    then the control decision is redundant */
 bool NBAIC::redundant(const CONTROL_DECISION& CD,
 					  const CONTROL_DECISION& used) const {
-	for (EVENT e = 0; e < CD.size(); ++e)
-		/* Event found in CD that was never used--CD is redundant */
-		if (CD[e] && !used[e]) return true;
-	/* No redundant event found */
-	return false;
+	/* Event found in CD that was never used--CD is redundant */
+	return !CD.is_subset_of(used);
 }
 
-/* Returns true if there exists a state in IS that cannot reach
-   either a marked state or an observable state */
-bool NBAIC::is_deadlocked(const INFO_STATE& IS, const CONTROL_DECISION& CD,
-						  const vector<int>& max_CD) {
-	INFO_STATE non_deadlocked(IS.size(), false);
-	for (STATE s = 0; s < IS.size(); ++s) {
-		if (!IS[s] || non_deadlocked[s]) continue;
-
-		INFO_STATE visited(IS.size(), false);
-		queue<Node<STATE>*> BFS;
-		Node<STATE>* root = new Node<STATE>(s);
-		BFS.push(root);
-		while (!BFS.empty()) {
-			Node<STATE>* current = BFS.front();
-			BFS.pop();
-
-			/* State initially marked or already found to be deadlock
-			free in the path of a previously checked state */
-			if (non_deadlocked[current->val] || fsm->marked[current->val]) {
-				record_path(non_deadlocked, current);
-				break;
+/* Returns true if there exists a state in IS that cannot reach either a
+   marked state or an enabled observable event under CD, a decision over all
+   events. One forward pass collects the region reachable from IS and the
+   states that are live outright; one backward pass over the reverse
+   transitions then spreads liveness to every state that can reach them */
+bool NBAIC::is_deadlocked(const INFO_STATE& IS, const CONTROL_DECISION& CD) {
+	/* Scratch space reused by every call on the same thread */
+	static thread_local Bitset follow, exits, region, live;
+	static thread_local vector<STATE> work;
+	/* Uncontrollable events are always allowed */
+	follow = CD;
+	follow |= fsm->uncontrollable_events;
+	exits = follow;
+	exits &= fsm->observable_events;
+	follow.and_not(fsm->observable_events);
+
+	region = IS;
+	live.resize(fsm->nstates);
+	live.reset();
+	work.clear();
+	for (STATE s = IS.find_first(); s != Bitset::npos; s = IS.find_next(s))
+		work.push_back(s);
+	while (!work.empty()) {
+		STATE current = work.back();
+		work.pop_back();
+		if (fsm->marked[current] || fsm->enabled_events[current].intersects(exits))
+			live.set(current);
+		for (int t = fsm->packed_offset[current];
+			 t < fsm->packed_offset[current + 1]; ++t)
+			if (follow[fsm->packed_event[t]] && !region[fsm->packed_state[t]]) {
+				region.set(fsm->packed_state[t]);
+				work.push_back(fsm->packed_state[t]);
 			}
-
-			if (visited[current->val]) continue;
-			visited[current->val] = true;
-			if (mode == BSCOPNBMAX)
-				check_BSCOPNBMAX_deadlock(max_CD, BFS, current,
-										  non_deadlocked, CD);
-			else if (mode == MPO) 
-				check_MPO_deadlock(max_CD, BFS, current,
-								  non_deadlocked, CD);
-			if (non_deadlocked[s]) break;
-		}
-		reset_tree(root);
-		/* Breadth first search couldn't find a path to an observable event or marked state */
-		if (!non_deadlocked[s]) return true;
 	}
-	return false;
-}
-
-void NBAIC::check_BSCOPNBMAX_deadlock(const vector<int>& max_CD,
-									  queue<Node<STATE>*>& BFS,
-									  Node<STATE>* current,
-									  INFO_STATE& non_deadlocked,
-									  const CONTROL_DECISION& CD) {
-	/* For all controllable events in CD defined at current state */
-	for (EVENT e = 0; e < max_CD.size(); ++e) {
-		if (CD[e] && fsm->transitions[current->val].find(max_CD[e])
-			!= fsm->transitions[current->val].end())
-			check_state_deadlock(BFS, current, max_CD[e], non_deadlocked, CD);
-	}
-	/* For all uncontrollable, unobservable events in CD defined at current state */
-	for (EVENT e = 0; e < fsm->uu.size(); ++e) {
-		if (fsm->transitions[current->val].find(fsm->uu[e])
-			!= fsm->transitions[current->val].end())
-			check_state_deadlock(BFS, current, fsm->uu[e], non_deadlocked, CD);
-	}
-	/* For all uncontrollable, observable events in CD defined at current state */
-	for (EVENT e = 0; e < fsm->uo.size(); ++e) {
-		if (fsm->transitions[current->val].find(fsm->uo[e])
-			!= fsm->transitions[current->val].end())
-			check_state_deadlock(BFS, current, fsm->uo[e], non_deadlocked, CD);
-	}
-}
-
-void NBAIC::check_MPO_deadlock(const vector<int>& max_SD,
-							   queue<Node<STATE>*>& BFS,
-							   Node<STATE>* current,
-							   INFO_STATE& non_deadlocked,
-							   const SENSING_DECISION& current_SD) {
-	for (EVENT e = 0; e < fsm->nevents; ++e) {
-		if (fsm->transitions[current->val].find(e)
-			!= fsm->transitions[current->val].end())
-			check_state_deadlock(BFS, current, e, non_deadlocked, current_SD);
-	}
-}
 
-void NBAIC::check_state_deadlock(queue<Node<STATE>*>& BFS, Node<STATE>* current,
-								 const EVENT e, INFO_STATE& non_deadlocked,
-								 const SENSING_DECISION& current_SD) {
-	/* Observable event defined for state within UR--state is not deadlocked */
-	if (fsm->observable[e] || (mode == MPO &&
-							   !currently_unobservable(fsm, current_SD, e)))
-		record_path(non_deadlocked, current);
-	else {
-		Node<STATE>* next = new Node<STATE>(fsm->transitions[current->val][e]);
-		next->prev = current;
-		current->next.push_back(next);
-		/* Marked state exists in UR--state is not deadlocked */
-		if (fsm->marked[next->val]) record_path(non_deadlocked, next);
-		/* Unobservable state exists in UR--keep going */
-		else BFS.push(next);
+	for (STATE s = live.find_first(); s != Bitset::npos; s = live.find_next(s))
+		work.push_back(s);
+	while (!work.empty()) {
+		STATE current = work.back();
+		work.pop_back();
+		for (int t = fsm->reverse_offset[current];
+			 t < fsm->reverse_offset[current + 1]; ++t) {
+			STATE prev = fsm->reverse_state[t];
+			if (region[prev] && !live[prev] && follow[fsm->reverse_event[t]]) {
+				live.set(prev);
+				work.push_back(prev);
+			}
+		}
 	}
+	return !IS.is_subset_of(live);
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////
 
 
-/* Map each NBAIC_State to a unique int */
-unordered_map<NBAIC_State*, int> NBAIC::create_NBAIC_index(bool Y, bool Z) const {
-	unordered_map<NBAIC_State*, int> NBAIC_index;
-	NBAIC_index.reserve(YSL.size() + ZSL.size());
-	int count = 0;
-	if (Y)
-		for (YS* ys : YSL) NBAIC_index[ys] = count++;
-	if (Z)
-		for (ZS* zs : ZSL) NBAIC_index[zs] = count++;
-	return NBAIC_index;
-}
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -740,21 +807,21 @@ void NBAIC::print(bool print_BDO /* = false */) {
 		for (auto& pair : ys->transition)
 			os << "\t\tZ-State with Information State {{"
 			   << get_subset_string(pair.second->IS, fsm->states) <<"},{"
-			   << get_subset_string((mode == MPO ? flag_observable(pair.first)
-			   									 : pair.first), fsm->events)
+			   << get_subset_string((mode == MPO ? flag_observable(NBAIC_State::CDs[pair.first])
+			   									 : NBAIC_State::CDs[pair.first]), fsm->events)
 			   << "}} via "
 			   << (mode != MPO ? "Control Decision" : "Sensing Decision")
 			   << " {"
-			   << get_subset_string((mode == MPO ? flag_observable(pair.first)
-			   									 : pair.first), fsm->events)
+			   << get_subset_string((mode == MPO ? flag_observable(NBAIC_State::CDs[pair.first])
+			   									 : NBAIC_State::CDs[pair.first]), fsm->events)
 			   << "}\n";
 	}
 	os << "Z-States:\n";
 	for (ZS* zs : ZSL) {
 		os << "\tInformation State: {{"
 		   << get_subset_string(zs->IS, fsm->states) <<"},{"
-		   << get_subset_string((mode == MPO ? flag_observable(zs->CD)
-			   									 : zs->CD), fsm->events)
+		   << get_subset_string((mode == MPO ? flag_observable(zs->get_CD())
+			   									 : zs->get_CD()), fsm->events)
 		   << "}}\n"
 		   << (zs->transition.empty() ? "" : "\tTransitions to:\n");
 		for (auto& pair : zs->transition)
@@ -770,34 +837,36 @@ void NBAIC::print(bool print_BDO /* = false */) {
 }
 
 void NBAIC::print_fsm(const char* const filename) {
-	ofstream file_os(filename);
-	file_os << YSL.size() + ZSL.size() << "\r\n\r\n";
+	Fsm_Writer out(filename, fsm);
+	out << YSL.size() + ZSL.size() << "\r\n\r\n";
 	for (YS* ys : YSL) {
-		file_os << '{' << get_subset_string(ys->IS, fsm->states) << "}	0	"
-				<< ys->transition.size() << "\r\n";
-		for (auto& pair : ys->transition)
-			file_os << '{' << get_subset_string((mode == MPO ? flag_observable(pair.first)
-			   												 : pair.first), fsm->events)
-					<< "}	{{" << get_subset_string(pair.second->IS, fsm->states)
-					<< "},{" << get_subset_string((mode == MPO ? flag_observable(pair.first)
-			   									 			   : pair.first), fsm->events)
-					<< "}}	c	o\r\n";
-		file_os << "\r\n";
+		out << '{' << IS_Names{ys} << "}	0	" << ys->transition.size() << "\r\n";
+		for (auto& pair : ys->transition) {
+			out << '{';
+			print_CD(out, pair.first);
+			out << "}	{{" << IS_Names{pair.second} << "},{";
+			print_CD(out, pair.first);
+			out << "}}	c	o\r\n";
+		}
+		out << "\r\n";
 	}
 	for (ZS* zs : ZSL) {
-		CONTROL_DECISION CD = get_CD(zs);
-		file_os << "{{" << get_subset_string(zs->IS, fsm->states) << "},{"
-				<< get_subset_string((mode == MPO ? flag_observable(CD)
-			   									  : CD), fsm->events) << "}}	1	"
-				<< zs->transition.size() << "\r\n";
+		/* Each Y-State reaches zs through the decision that created it */
+		out << "{{" << IS_Names{zs} << "},{";
+		print_CD(out, zs->CD);
+		out << "}}	1	" << zs->transition.size() << "\r\n";
 		for (auto& pair : zs->transition)
-			file_os << fsm->events.get_key(pair.first) << "	{"
-					<< get_subset_string(pair.second->IS, fsm->states) << "}	"
-					<< print_event_parameters(pair.first) << "\r\n";
-		file_os << "\r\n";
+			out << Event_Name{pair.first} << "	{" << IS_Names{pair.second} << "}	"
+				<< print_event_parameters(pair.first) << "\r\n";
+		out << "\r\n";
 	}
-	file_os<<endl;
-	file_os.close();
+	out << '\n';
+}
+
+/* Under MPO only the observable events of a control decision are shown */
+void NBAIC::print_CD(Fsm_Writer& out, CD_ID CD) {
+	if (mode == MPO) out << Event_Names{flag_observable(NBAIC_State::CDs[CD])};
+	else out << CD_Names{CD};
 }
 
 string NBAIC::print_event_parameters(EVENT e) {
@@ -848,12 +917,10 @@ void NBAIC::deadlock_test(const INFO_STATE& IS) {
 			event_pset >>= 1;
 			if (event_pset == 0) break;
 		}
-		vector<int> max_CD(fsm->nevents);
-		iota(max_CD.begin(), max_CD.end(), 0);
 		os << "Control Decision: {"
 		   << get_subset_string(current_CD, fsm->events) << "}\n"
 		   << "Deadlock: "
-		   << (is_deadlocked(IS, current_CD, max_CD) ? "yes" : "no") << "\n\n";
+		   << (is_deadlocked(IS, current_CD) ? "yes" : "no") << "\n\n";
 	}
 }
 
@@ -901,20 +968,12 @@ CONTROL_DECISION convert_to_all_events(const CONTROL_DECISION& CD,
 									   const vector<int>& max_CD,
 									   const int nevents) {
 	CONTROL_DECISION result(nevents);
-	for (EVENT e = 0; e < CD.size(); ++e)
-		if (CD[e]) result[max_CD[e]] = true;
+	for (EVENT e = CD.find_first(); e != Bitset::npos; e = CD.find_next(e))
+		result[max_CD[e]] = true;
 	return result;
 }
 
-template <typename BOOL_CONTAINER>
-void record_path(BOOL_CONTAINER& bc, Node<STATE>* current) {
-	bc[current->val] = true;
-	if (!current->prev) return;
-	else record_path(bc, current->prev);
-}
-
-bool all_deleted(unordered_map<CONTROL_DECISION, ZS*,
-				 			   hash<CONTROL_DECISION>>& transition) {
+bool all_deleted(unordered_map<CD_ID, ZS*>& transition) {
 	auto iter = transition.begin();
 	while (iter != transition.end()) {
 		auto current = iter++;
@@ -940,27 +999,18 @@ bool IS_match(const NBAIC_State* nbs, const INFO_STATE& IS, bool& match) {
 	return match;
 }
 
+/* Z-States are identified by both their IS and the CD that created them */
+size_t ZS_hash(const INFO_STATE& IS, CD_ID CD) {
+	return IS.hash() ^ (hash<CD_ID>()(CD) * 31);
+}
+
 template <typename NBAIC_MAP>
-void push_children(queue<Node<NBAIC_State*>*>& BFS,
-				   Node<NBAIC_State*>* parent, NBAIC_MAP& nbaic_map) {
-	/* For each child state that has not been deleted */
+void push_children(Ring_Queue<NBAIC_State*>& BFS, NBAIC_MAP& nbaic_map) {
+	/* Add each child state that has not been deleted to the queue */
 	for (auto& pair : nbaic_map)
-		if (!pair.second->deleted) {
-			/* Add child to the queue */
-			Node<NBAIC_State*>* child = new Node<NBAIC_State*>(pair.second);
-			child->prev = parent;
-			parent->next.push_back(child);
-			BFS.push(child);
-		}
+		if (!pair.second->deleted) BFS.push(pair.second);
 }
 
-template <typename State_List>
-void mark_deleted_helper(vector<bool>& accessible, int& index,
-						 STATE s, State_List& sl) {
-	/* Delete state sl[s] if it is inaccessble */
-	if (!accessible[index]) sl[s]->deleted = true;
-	++index;
-}
 
 
 bool currently_unobservable(FSM* fsm, const SENSING_DECISION& current_SD,
@@ -975,9 +1025,9 @@ bool currently_unobservable(FSM* fsm, const SENSING_DECISION& current_SD,
 		|| !(fsm->monitorable[max_SD[e]] || fsm->observable[max_SD[e]]);
 }
 
-void remove_transition(YS* ys, const SENSING_DECISION* SD) {
-	ys->transition[*SD]->reverse.erase(*SD);
-	ys->transition.erase(*SD);
+void remove_transition(YS* ys, CD_ID SD) {
+	ys->transition[SD]->reverse.erase(SD);
+	ys->transition.erase(SD);
 }
 
 string get_title(Mode mode, bool print_BDO, bool is_end) {
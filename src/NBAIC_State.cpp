@@ -3,12 +3,13 @@ using namespace std;
 
 int NBAIC_State::nstates = 0;
 int NBAIC_State::nevents = 0;
+Intern_Table<CONTROL_DECISION> NBAIC_State::CDs;
 
 NBAIC_State::NBAIC_State(const bool deleted_, const bool is_YS_)
-  : deleted(deleted_), is_YS(is_YS_) {}
+  : id(-1), deleted(deleted_), is_YS(is_YS_) {}
 NBAIC_State::NBAIC_State(const bool deleted_, const bool is_YS_,
 						 const INFO_STATE& IS_)
-  : deleted(deleted_), is_YS(is_YS_), IS(IS_) {}
+  : id(-1), deleted(deleted_), is_YS(is_YS_), IS(IS_) {}
 
 string NBAIC_State::print() const {
 	string result;
@@ -22,5 +23,5 @@ string NBAIC_State::print() const {
 YS::YS() : NBAIC_State(false, true) { IS.resize(nstates); }
 YS::YS(const INFO_STATE& IS_) : NBAIC_State(false, true, IS_) {}
 
-ZS::ZS() : NBAIC_State(false, false) { IS.resize(nstates); }
-ZS::ZS(const INFO_STATE& IS_, CONTROL_DECISION CD_) : NBAIC_State(false, false, IS_), CD(CD_){}
\ No newline at end of file
+ZS::ZS() : NBAIC_State(false, false), CD(-1) { IS.resize(nstates); }
+ZS::ZS(const INFO_STATE& IS_, CD_ID CD_) : NBAIC_State(false, false, IS_), CD(CD_){}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "../include/Reach_Cache.h"
+using namespace std;
+
+Reach_Cache::Reach_Cache(size_t capacity_ /*= DEFAULT_CAPACITY*/)
+	: capacity(capacity_), used(0), hits(0), misses(0) {}
+
+/* Copies the cached outcome of (IS, CD) into entry if there is one */
+bool Reach_Cache::find(const INFO_STATE& IS, const CONTROL_DECISION& CD,
+					   Entry& entry) {
+	lock_guard<mutex> guard(lock);
+	auto it = entries.find(Key(IS, CD));
+	if (it == entries.end()) {
+		++misses;
+		return false;
+	}
+	++hits;
+	entry = it->second;
+	return true;
+}
+
+void Reach_Cache::insert(const INFO_STATE& IS, const CONTROL_DECISION& CD,
+						 const Entry& entry) {
+	Key key(IS, CD);
+	size_t size = size_of(key, entry);
+	if (size > capacity) return;
+	lock_guard<mutex> guard(lock);
+	/* Another thread may have evaluated the same decision first */
+	if (!entries.insert(make_pair(key, entry)).second) return;
+	insertion_order.push_back(key);
+	used += size;
+	/* Evict the oldest entries until we are back under capacity */
+	while (used > capacity) {
+		auto oldest = entries.find(insertion_order.front());
+		used -= size_of(oldest->first, oldest->second);
+		entries.erase(oldest);
+		insertion_order.pop_front();
+	}
+}
+
+void Reach_Cache::print_stats(ostream& os) const {
+	lock_guard<mutex> guard(lock);
+	os << "Reach cache: " << hits << " hits, " << misses << " misses, "
+	   << entries.size() << " entries (" << used << " bytes)\n";
+}
+
+/* Approximate memory held by one entry, counting the key twice since
+insertion_order keeps its own copy */
+size_t Reach_Cache::size_of(const Key& key, const Entry& entry) {
+	return 2 * (sizeof(Key) + (key.first.num_words() + key.second.num_words())
+				* sizeof(Bitset::Word))
+		   + sizeof(Entry) + entry.UR_transitions.size() * sizeof(Transition);
+}
@@ -1,45 +1,51 @@
 #include <queue>
 #include "../include/UBTS.h"
 #include "../include/Utilities.h"
+#include "../include/Fsm_Writer.h"
 using namespace std;
 
-static CONTROL_DECISION get_locally_maximal_CD(Y_UBTS* y_ubts, ZS*& zs);
-template <typename State_Type, typename State_List>
-bool is_duplicate(State_Type*& st, State_List& sl);
+static CD_ID get_locally_maximal_CD(Y_UBTS* y_ubts, ZS*& zs);
+static size_t UBTS_hash(NBAIC_State* nbs, int num_predecessors);
 
 
 ///////////////////////////////////////////////////////////////////////////////
 
 
 UBTS_State::UBTS_State(NBAIC_State* nbs_, int num_predecessors_)
-	: nbs(nbs_), num_predecessors(num_predecessors_),
+	: nbs(nbs_), id(-1), num_predecessors(num_predecessors_),
 	  disambiguation_state(nullptr) {}
 
-bool UBTS_State::operator==(const UBTS_State& rhs) const {
-	return nbs == rhs.nbs && num_predecessors == rhs.num_predecessors;
-}
-
 
 ///////////////////////////////////////////////////////////////////////////////
 
 
 UBTS::UBTS(NBAIC* nbaic_, ostream& os_) : nbaic(nbaic_), os(os_),
 										  transient_state_index(-1),
-										  terminal_Y_UBTS(nullptr) {
-	YSL.push_back(new Y_UBTS(nbaic->YSL[0]));
+										  terminal_Y_UBTS(nullptr),
+										  synced_YSL(0), synced_ZSL(0),
+										  visited_YSL(0), visited_ZSL(0) {
+	YSL.push_back(Y_pool.create(nbaic->YSL[0]));
+	add_UBTS_State(YSL.back());
 }
 
-UBTS::~UBTS() {
-	for (Y_UBTS* y_ubts : YSL) delete y_ubts;
-	for (Z_UBTS* z_ubts : ZSL) delete z_ubts; 
-}
+/* States are released with their pools */
+UBTS::~UBTS() {}
 
 
 ///////////////////////////////////////////////////////////////////////////////
 
 
+/* Visits states in the order they were added, Y-States first. Visiting a
+Y-State only adds Z-States and a visited state stays visited, so each state
+is looked at once */
 void UBTS::expand() {
-	while (exists_unvisited_Y_UBTS() || exists_unvisited_Z_UBTS()) {}
+	while (true) {
+		for (; visited_YSL < YSL.size(); ++visited_YSL)
+			if (Y_UBTS_is_unvisited(YSL[visited_YSL]))
+				visit_Y_UBTS(YSL[visited_YSL]);
+		if (visited_ZSL == ZSL.size()) break;
+		visit_Z_UBTS(ZSL[visited_ZSL++]);
+	}
 }
 
 void UBTS::augment(LDS& lds) {
@@ -49,23 +55,33 @@ void UBTS::augment(LDS& lds) {
 	/* Alternate adding Z and Y states based on the controls in the LDS */
 	while (i < lds.CDs.size()) {
 		ZS* zs = next_Y->get_YS()->transition[lds.CDs[i]];
-		Z_UBTS* next_Z = new Z_UBTS(zs, transient_state_index--, lds.CDs[i]);
+		Z_UBTS* next_Z = Z_pool.create(zs, transient_state_index--,
+										lds.CDs[i]);
+		if (next_Y == terminal_Y_UBTS) extended.push_back(next_Y);
 		next_Y->child = next_Z;
 		next_Z->parents.push_back(next_Y);
 		ZSL.push_back(next_Z);
+		add_UBTS_State(next_Z);
 
 		if (i == lds.events.size()) break;
 
 		YS* ys = next_Z->get_ZS()->transition[lds.events[i]];
-		next_Y = new Y_UBTS(ys, transient_state_index--);
+		next_Y = Y_pool.create(ys, transient_state_index--);
 		next_Z->children[lds.events[i]] = next_Y;
 		next_Y->parents.push_back(next_Z);
 		YSL.push_back(next_Y);
+		add_UBTS_State(next_Y);
 		++i;
 	}
 	terminal_Y_UBTS = nullptr;
 }
 
+void UBTS::mark_synced() {
+	synced_YSL = YSL.size();
+	synced_ZSL = ZSL.size();
+	extended.clear();
+}
+
 void UBTS::print() {
 	os << "*******************************************************************\n"
 	   << "**************Unfolded Bipartite Transition System*****************\n"
@@ -83,7 +99,7 @@ void UBTS::print() {
 				   << get_subset_string(y_ubts->child->get_ZS()->IS, nbaic->fsm->states)
 				   << "}," << y_ubts->child->num_predecessors
 				   << "} via Control Decision {"
-				   << get_subset_string(y_ubts->child->CD, nbaic->fsm->events)
+				   << get_subset_string(y_ubts->child->get_CD(), nbaic->fsm->events)
 				   << "}\n";
 		}
 		os << "Z-States:\n";
@@ -106,35 +122,29 @@ void UBTS::print() {
 }
 
 void UBTS::print(const char* const filename, bool print_ebts) {
-	ofstream file_out(filename);
-	file_out << YSL.size() + ZSL.size() - (print_ebts ? count_childless_Y_UBTS() : 0) 
+	Fsm_Writer file_out(filename, nbaic->fsm);
+	file_out << YSL.size() + ZSL.size() - (print_ebts ? count_childless_Y_UBTS() : 0)
 			 << "\r\n\r\n";
 	for (Y_UBTS* y_ubts : YSL) {
 		if (print_ebts && !y_ubts->child) continue;
-		file_out << "{{" << get_subset_string(y_ubts->get_YS()->IS,
-											  nbaic->fsm->states) << "},"
+		file_out << "{{" << IS_Names{y_ubts->nbs} << "},"
 				 << y_ubts->num_predecessors << "}	0	"
 				 << (y_ubts->child ? "1" : "0") << "\r\n";
 		if (y_ubts->child)
-			file_out << '{' << get_subset_string(y_ubts->child->CD,
-												 nbaic->fsm->events) << "}	{{"
-					 << get_subset_string(y_ubts->child->get_ZS()->IS,
-					 					  nbaic->fsm->states) << "},{"
-					 << get_subset_string(y_ubts->child->CD,
-					 					  nbaic->fsm->events) << "},"
+			file_out << '{' << CD_Names{y_ubts->child->CD} << "}	{{"
+					 << IS_Names{y_ubts->child->nbs} << "},{"
+					 << CD_Names{y_ubts->child->CD} << "},"
 					 << y_ubts->child->num_predecessors << "}	c	o\r\n";
 		file_out << "\r\n";
 	}
 	for (Z_UBTS* z_ubts : ZSL) {
-		file_out << "{{" << get_subset_string(z_ubts->get_ZS()->IS,
-											 nbaic->fsm->states) << "},{"
-				 << get_subset_string(z_ubts->CD, nbaic->fsm->events) << "},"
+		file_out << "{{" << IS_Names{z_ubts->nbs} << "},{"
+				 << CD_Names{z_ubts->CD} << "},"
 				 << z_ubts->num_predecessors << "}	1	"
 				 << z_ubts->children.size() << "\r\n";
 		for (auto& pair : z_ubts->children)
-			file_out << nbaic->fsm->events.get_key(pair.first) << "	{{"
-					 << get_subset_string(pair.second->get_YS()->IS,
-					 					  nbaic->fsm->states) << "},"
+			file_out << Event_Name{pair.first} << "	{{"
+					 << IS_Names{pair.second->nbs} << "},"
 					 << (print_ebts && !pair.second->child ?
 					 	 0 : pair.second->num_predecessors) << "}	"
 					 << (nbaic->fsm->controllable[pair.first] ? "c	" : "uc	")
@@ -149,44 +159,12 @@ void UBTS::print(const char* const filename, bool print_ebts) {
 ///////////////////////////////////////////////////////////////////////////////
 
 
-bool UBTS::exists_unvisited_Y_UBTS() {
-	for (Y_UBTS* y_ubts : YSL) {
-		if (Y_UBTS_is_unvisited(y_ubts)) {
-			visit_Y_UBTS(y_ubts);
-			return true;
-		}
-	}
-	return false;
-}
-
-bool UBTS::exists_unvisited_Z_UBTS() {
-	for (Z_UBTS* z_ubts : ZSL) {
-		if (Z_UBTS_is_unvisited(z_ubts)) {
-			visit_Z_UBTS(z_ubts);
-			return true;
-		}
-	}
-	return false;
-}
-
 bool UBTS::Y_UBTS_is_unvisited(Y_UBTS* y_ubts) {
 	/* Y_UBTS State is the first with its NBAIC_State and has
 	no outgoing control decisions */
 	return y_ubts->num_predecessors == 0 && !y_ubts->child;
 }
 
-bool UBTS::Z_UBTS_is_unvisited(Z_UBTS* z_ubts) {
-	/* For all observable, controllable events in the control decision */
-	for (EVENT e = 0; e < z_ubts->CD.size(); ++e)
-		if (z_ubts->CD[e] && nbaic->fsm->observable[e]
-			&& Z_UBTS_is_missing_transition(z_ubts, e)) return true;
-	/* For all observable, uncontrollable events */
-	for (EVENT e = 0; e < nbaic->fsm->uo.size(); ++e)
-		if (Z_UBTS_is_missing_transition(z_ubts, nbaic->fsm->uo[e])) return true;
-	/* No missing transitions */
-	return false;
-}
-
 bool UBTS::Z_UBTS_is_missing_transition(Z_UBTS* z_ubts, EVENT e) {
 	/* Event is defined for NBAIC_State and not for UBTS_State*/
 	if (z_ubts->get_ZS()->transition.find(e)
@@ -199,19 +177,25 @@ bool UBTS::Z_UBTS_is_missing_transition(Z_UBTS* z_ubts, EVENT e) {
 
 void UBTS::visit_Y_UBTS(Y_UBTS* y_ubts) {
 	ZS* zs = nullptr;
-	CONTROL_DECISION CD = get_locally_maximal_CD(y_ubts, zs);
-	/* Child Z-State of the passed-in y_ubts */
-	Z_UBTS* child = new Z_UBTS(zs, CD);
+	CD_ID CD = get_locally_maximal_CD(y_ubts, zs);
+	int num_predecessors = get_num_predecessors(zs, y_ubts);
+	/* Child Z-State of the passed-in y_ubts--reuse the state if it is
+	already in the UBTS */
+	Z_UBTS* child = static_cast<Z_UBTS*>(get_UBTS_State(zs, num_predecessors));
+	if (!child) {
+		child = Z_pool.create(zs, num_predecessors, CD);
+		ZSL.push_back(child);
+		add_UBTS_State(child);
+	}
 	child->parents.push_back(y_ubts);
-	child->num_predecessors = get_num_predecessors(child);
-	if (!is_duplicate(child, ZSL)) ZSL.push_back(child);
 	y_ubts->child = child;
 }
 
 void UBTS::visit_Z_UBTS(Z_UBTS* z_ubts) {
+	const CONTROL_DECISION& CD = z_ubts->get_CD();
 	/* For all observable, controllable events in the control decision */
-	for (EVENT e = 0; e < z_ubts->CD.size(); ++e)
-		if (z_ubts->CD[e] && nbaic->fsm->observable[e]
+	for (EVENT e = 0; e < CD.size(); ++e)
+		if (CD[e] && nbaic->fsm->observable[e]
 			&& Z_UBTS_is_missing_transition(z_ubts, e))
 			add_child(z_ubts, e);
 	/* For all observable, uncontrollable events */
@@ -222,70 +206,71 @@ void UBTS::visit_Z_UBTS(Z_UBTS* z_ubts) {
 
 void UBTS::add_child(Z_UBTS* z_ubts, EVENT e) {
 	YS* ys = z_ubts->get_ZS()->transition[e];
-	/* Child Y-State of the passed-in z_ubts */
-	Y_UBTS* child = new Y_UBTS(ys);
+	int num_predecessors = get_num_predecessors(ys, z_ubts);
+	/* Child Y-State of the passed-in z_ubts--reuse the state if it is
+	already in the UBTS */
+	Y_UBTS* child = static_cast<Y_UBTS*>(get_UBTS_State(ys, num_predecessors));
+	if (!child) {
+		child = Y_pool.create(ys, num_predecessors);
+		YSL.push_back(child);
+		add_UBTS_State(child);
+	}
 	child->parents.push_back(z_ubts);
-	child->num_predecessors = get_num_predecessors(child);
-	if (!is_duplicate(child, YSL)) YSL.push_back(child);
 	z_ubts->children[e] = child;
 }
 
-int UBTS::get_num_predecessors(UBTS_State* ubts_state) {
-	unordered_map<UBTS_State*, int> UBTS_index = create_UBTS_index();
-	vector<bool> visited(UBTS_index.size());
-	queue<Node<UBTS_State*>*> BFS; /* Breadth First Search */
-	Node<UBTS_State*>* root = new Node<UBTS_State*>(ubts_state);
-	BFS.push(root);
+/* num_predecessors for a new state of nbs under parent: one more than the
+nearest ancestor with the same NBAIC_State, or 0 if there is none */
+int UBTS::get_num_predecessors(NBAIC_State* nbs, UBTS_State* parent) {
+	/* Every state of nbs descends from the one with no predecessors--
+	if there is none, no ancestor can match */
+	if (!get_UBTS_State(nbs, 0)) return 0;
+	/* Y- and Z-State ids overlap, so they take alternate slots */
+	visited.resize(2 * max(Y_pool.capacity(), Z_pool.capacity()));
+	visited.clear();
+	BFS.clear();
+	BFS.push(parent);
 	while (!BFS.empty()) {
-		Node<UBTS_State*>* current = BFS.front();
+		UBTS_State* current = BFS.front();
 		BFS.pop();
 		/* Prevent infinite loops */
-		if (visited[UBTS_index[current->val]]) continue;
-		visited[UBTS_index[current->val]] = true;
-		/* For each immediate parent state of the current node */
-		for (UBTS_State* parent : current->val->parents) {
-			/* NBAIC_States are the same and parent is not a transient state--
-			root state's num_predecessors is one more than current's */
-			if (ubts_state->nbs == parent->nbs
-				&& parent->num_predecessors >= 0) {
-				reset_tree(root);
-				return parent->num_predecessors + 1;
-			}
-			/* NBAIC_States differ--keep searching */
-			else {
-				Node<UBTS_State*>* next = new Node<UBTS_State*>(parent);
-				current->next.push_back(next);
-				BFS.push(next);
-			}
-		}
+		if (!visited.insert(2 * current->id + !current->is_Y_UBTS())) continue;
+		/* NBAIC_States are the same and current is not a transient state--
+		new state's num_predecessors is one more than current's */
+		if (current->nbs == nbs && current->num_predecessors >= 0)
+			return current->num_predecessors + 1;
+		/* NBAIC_States differ--keep searching */
+		for (UBTS_State* next : current->parents) BFS.push(next);
 	}
-	reset_tree(root);
 	/* BFS could not find matching, predecessor NBAIC_State--
 	state is unique for this path */
 	return 0;
 }
 
-/* Map each UBTS_State to a unique int */
-unordered_map<UBTS_State*, int> UBTS::create_UBTS_index() {
-	unordered_map<UBTS_State*, int> UBTS_index;
-	UBTS_index.reserve(YSL.size() + ZSL.size());
-	int count = 0;
-	for (auto y_ubts : YSL) UBTS_index[y_ubts] = count++;
-	for (auto z_ubts : ZSL) UBTS_index[z_ubts] = count++;
-	return UBTS_index;
+UBTS_State* UBTS::get_UBTS_State(NBAIC_State* nbs, int num_predecessors) {
+	/* For all states whose key shares a hash with ours */
+	auto range = UBTS_index.equal_range(UBTS_hash(nbs, num_predecessors));
+	for (auto it = range.first; it != range.second; ++it)
+		if (it->second->nbs == nbs
+			&& it->second->num_predecessors == num_predecessors)
+			return it->second;
+	return nullptr;
+}
+
+void UBTS::add_UBTS_State(UBTS_State* ubts_state) {
+	UBTS_index.insert(make_pair(UBTS_hash(ubts_state->nbs,
+										  ubts_state->num_predecessors),
+								ubts_state));
 }
 
 bool UBTS::is_terminal_Y_UBTS(ICS_STATE* ics_state) {
-	NBAIC_State* nbs = ics_state->get_nbs();
-	int index = ics_state->get_transient_index();
-	for (Y_UBTS* y_ubts : YSL)
-		/* Y_UBTS State is a terminal state with a matching NBAIC_State */
-		if (y_ubts->nbs == nbs
-			&& index == y_ubts->num_predecessors
-			&& !y_ubts->child) {
-			terminal_Y_UBTS = y_ubts;
-			return true;
-		}
+	UBTS_State* match = get_UBTS_State(ics_state->get_nbs(),
+									   ics_state->get_transient_index());
+	/* Y_UBTS State is a terminal state with a matching NBAIC_State */
+	if (match && match->is_Y_UBTS() && !static_cast<Y_UBTS*>(match)->child) {
+		terminal_Y_UBTS = static_cast<Y_UBTS*>(match);
+		return true;
+	}
 	/* No matching terminal state exists */
 	return false;
 }
@@ -312,27 +297,20 @@ int UBTS::count_childless_Y_UBTS() {
 ///////////////////////////////////////////////////////////////////////////////
 
 
-static CONTROL_DECISION get_locally_maximal_CD(Y_UBTS* y_ubts, ZS*& zs) {
-	CONTROL_DECISION result(zs->nevents, false);
+static CD_ID get_locally_maximal_CD(Y_UBTS* y_ubts, ZS*& zs) {
+	CD_ID result = -1;
 	for (auto& pair : y_ubts->get_YS()->transition)
-		if (is_subset(result, pair.first)) {
+		if (result < 0 || is_subset(NBAIC_State::CDs[result],
+									NBAIC_State::CDs[pair.first])) {
 			result = pair.first;
 			zs = pair.second;
 		}
+	/* No decisions--fall back on the empty one */
+	if (result < 0)
+		result = NBAIC_State::CDs.intern(CONTROL_DECISION(NBAIC_State::nevents, false));
 	return result;
 }
 
-template <typename State_Type, typename State_List>
-bool is_duplicate(State_Type*& st, State_List& sl) {
-	for (auto state : sl) {
-		/* State already in UBTS--delete new state and use existing */
-		if (*st == *state) {
-			state->parents.push_back(move(st->parents.front()));
-			delete st;
-			st = state;
-			return true;
-		}
-	}
-	/* No duplicate found in State List--use new state */
-	return false;
+static size_t UBTS_hash(NBAIC_State* nbs, int num_predecessors) {
+	return hash<NBAIC_State*>()(nbs) ^ (hash<int>()(num_predecessors) * 31);
 }
\ No newline at end of file
@@ -9,17 +9,29 @@ SUPV::SUPV(CSR* csr_): DBTS(csr_->os){
 	req_fsm = csr->dbts->req_fsm;
 	req_states = csr->dbts->req_states;
 	/* Create initial Y-State */
-	Y_DBTS* y0 = new Y_DBTS(aic->YSL[0]);
+	bool judge;
+	Y_DBTS* y0 = get_Y_DBTS(aic->YSL[0], judge);
 	YSL.push_back(y0);
 	for (auto i:csr->dbts->YSL){
 		Y_req_map[i->get_YS()] = i;
 	}
-	DoDFS_sol(y0,csr->dbts->YSL[0]);
+	explore_sol(y0,csr->dbts->YSL[0]);
 }
 
+/* Visits the supervisor's Y-States with an explicit worklist, pairing each
+with its counterpart in T_R (or nullptr when it has none) */
+void SUPV::explore_sol(Y_DBTS* y0, Y_DBTS* y0_bar){
+	vector<pair<Y_DBTS*, Y_DBTS*>> worklist(1, make_pair(y0, y0_bar));
+	while (!worklist.empty()){
+		pair<Y_DBTS*, Y_DBTS*> current = worklist.back();
+		worklist.pop_back();
+		expand_sol(current.first, current.second, worklist);
+	}
+}
 
-void SUPV::DoDFS_sol(Y_DBTS* y, Y_DBTS* y_bar){
-	CONTROL_DECISION Act;
+void SUPV::expand_sol(Y_DBTS* y, Y_DBTS* y_bar,
+					  vector<pair<Y_DBTS*, Y_DBTS*>>& worklist){
+	CD_ID Act;
 	YS* y_state = y->get_YS();
 
 	if (if_contain(y_state) && y_bar){
@@ -59,7 +71,7 @@ void SUPV::DoDFS_sol(Y_DBTS* y, Y_DBTS* y_bar){
 				new_y_bar = nullptr;
 			if (!judge_y){
 				YSL.push_back(new_y);
-				DoDFS_sol(new_y, new_y_bar);
+				worklist.push_back(make_pair(new_y, new_y_bar));
 			}
 		}
 	}
@@ -67,23 +79,18 @@ void SUPV::DoDFS_sol(Y_DBTS* y, Y_DBTS* y_bar){
 }
 
 bool SUPV::if_contain(YS* y){
-	for (STATE i = 0; i < aic->fsm->nstates; i++){
-		if (y->IS[i] && req_states[i]){
-			return true;
-		}
-	}
-	return false;
+	return y->IS.intersects(req_states);
 }
 
-CONTROL_DECISION SUPV::get_max_R(YS* y,Y_DBTS* y_bar){
+CD_ID SUPV::get_max_R(YS* y,Y_DBTS* y_bar){
 	//get the CD with the biggest possiblities.
 	int maxCD = -1;
 	int maxIS = -1;
-	CONTROL_DECISION result(aic->fsm->nevents, false);
+	CD_ID result = NBAIC_State::CDs.intern(CONTROL_DECISION(aic->fsm->nevents, false));
 	for (auto i:y->transition){
 		if (y_bar->child){
-			if (csr->Z_map.find(csr->Z_pair_pointers[i.second][y_bar->child])!=csr->Z_map.end()
-				&& is_subset(i.second->CD, y_bar->child->CD)){
+			if (csr->contains(i.second, y_bar->child)
+				&& is_subset(i.second->get_CD(), y_bar->child->get_CD())){
 				int num_CD = get_numCD(i.second);
 				int num_IS = get_numIS(i.second);
 				if (maxCD < num_CD || maxIS < num_IS){
@@ -97,11 +104,11 @@ CONTROL_DECISION SUPV::get_max_R(YS* y,Y_DBTS* y_bar){
 	return result;
 }
 
-CONTROL_DECISION SUPV::get_max(YS* y){
+CD_ID SUPV::get_max(YS* y){
 	//get the CD with the biggest possiblities.
 	int maxCD = -1;
 	int maxIS = -1;
-	CONTROL_DECISION result;
+	CD_ID result = NBAIC_State::CDs.intern(CONTROL_DECISION());
 	for (auto i:y->transition){
 		int num_CD = get_numCD(i.second);
 		int num_IS = get_numIS(i.second);
@@ -118,27 +125,15 @@ CONTROL_DECISION SUPV::get_max(YS* y){
 
 int SUPV::get_numCD(ZS* z){
 	//get the number of events in the CD
-	int result = 0;
-	for (auto i:z->CD)
-		if (i)
-			result ++;
-    return result;
+	return z->get_CD().count();
 }
 
 int SUPV::get_numIS(ZS* z){
 	//get the number of states of the IS
-	int result = 0;
-	for (auto i:z->IS)
-		if (i)
-			result ++;
-    return result;
+	return z->IS.count();
 }
 
 bool SUPV::is_subset(const CONTROL_DECISION& CD1,const CONTROL_DECISION& CD2){
 	//determine whether CD2 is a subset of CD1
-	for (EVENT i = 0; i < aic->fsm->nevents; i++){
-		if ((CD2[i])&&(!CD1[i]))
-			return false;
-	}
-	return true;
+	return CD2.is_subset_of(CD1);
 }
\ No newline at end of file